@@ -0,0 +1,74 @@
+/**
+ * @file eigen-bench.cpp
+ * @brief Timing of the algorithms of `kspc::hermitian::eigen_solve`
+ * compiler option:
+ * -O3 -std=c++20 -llapack -lblas -march=native
+ */
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+#include <kspc/linalg.hpp>
+
+namespace hermitian = kspc::hermitian;
+
+// random hermitian matrix in column-major order
+auto random_hermitian(const std::size_t n, std::mt19937& gen) {
+  std::normal_distribution<double> dist;
+  std::vector<std::complex<double>> A(n * n);
+  for (std::size_t j = 0; j < n; ++j) {
+    A[j + j * n] = dist(gen);
+    for (std::size_t i = 0; i < j; ++i) {
+      A[i + j * n] = {dist(gen), dist(gen)};
+      A[j + i * n] = std::conj(A[i + j * n]);
+    }
+  }
+  return A;
+}
+
+// best time in milliseconds of `reps` diagonalizations
+double time_eigen_solve(const std::vector<std::complex<double>>& A0, hermitian::algorithm algo,
+                        std::size_t reps) {
+  const auto n = kspc::dim(A0);
+  std::vector<double> w(n);
+  hermitian::eigen_workspace<std::complex<double>> ws;
+  double best = std::numeric_limits<double>::max();
+  for (std::size_t r = 0; r < reps; ++r) {
+    auto A = A0;
+    const auto start = std::chrono::steady_clock::now();
+    hermitian::eigen_solve(A, w, ws, algo);
+    const auto stop = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+  }
+  return best;
+}
+
+int main() {
+  std::mt19937 gen(0);
+  const std::pair<hermitian::algorithm, const char*> algos[] = {
+    {hermitian::algorithm::qr, "qr"},
+    {hermitian::algorithm::divide_and_conquer, "d&c"},
+    {hermitian::algorithm::mrrr, "mrrr"},
+    {hermitian::algorithm::automatic, "auto"},
+  };
+
+  std::cout << "# time [ms] of hermitian::eigen_solve (complex<double>)\n";
+  std::cout << "#     n";
+  for (const auto& [algo, name] : algos) std::cout << std::setw(10) << name;
+  std::cout << "  auto selects\n";
+  for (const std::size_t n : std::array<std::size_t, 8>{8, 16, 32, 64, 128, 256, 512, 1024}) {
+    const auto A = random_hermitian(n, gen);
+    const std::size_t reps = std::max<std::size_t>(3, 4096 / n);
+    std::cout << std::setw(7) << n;
+    for (const auto& [algo, name] : algos)
+      std::cout << std::setw(10) << std::setprecision(4) << time_eigen_solve(A, algo, reps);
+    const auto selected = hermitian::resolve_algorithm(hermitian::algorithm::automatic, n);
+    for (const auto& [algo, name] : algos)
+      if (algo == selected) std::cout << "  " << name << "\n";
+  }
+}
@@ -106,17 +106,16 @@ double Bz_(const std::vector<double>& k, void* temp_p_params) {
   constexpr auto row_major = kspc::mapping::row_major(Nsite);
   kspc::hermitian::eigen_solve(H, E, row_major);
 
-  auto dHdkx = dHdkx_(k, temp_p_params);
-  auto dHdky = dHdky_(k, temp_p_params);
-  kspc::unitary_transform(dHdkx, H, row_major, row_major);
-  kspc::unitary_transform(dHdky, H, row_major, row_major);
+  const auto dHdkx = dHdkx_(k, temp_p_params);
+  const auto dHdky = dHdky_(k, temp_p_params);
+  constexpr std::size_t n = 0;
+  // vx[m] = <n|dH/dkx|m>, vy[m] = <n|dH/dky|m>, and <m|dH/dky|n> = conj(vy[m])
+  std::array<std::complex<double>, Nsite> vx, vy;
+  kspc::matrix_elements(std::tie(dHdkx, dHdky), H, n, std::tie(vx, vy), row_major, row_major);
 
   double bz = 0.0;
-  constexpr std::size_t n = 0;
   for (std::size_t m = 0; m < Nsite; ++m) {
-    if (m != n)
-      bz -=
-        2.0 * std::imag(dHdkx[row_major(n, m)] * dHdky[row_major(m, n)]) / std::pow(E[n] - E[m], 2);
+    if (m != n) bz -= 2.0 * std::imag(vx[m] * std::conj(vy[m])) / std::pow(E[n] - E[m], 2);
   }
   return bz;
 }
@@ -45,5 +45,9 @@ int main() {
     const auto sz = fn2(v, &params);
     std::cout << v[0] << " " << v[1] << " " << sz << "\n";
   }
-  for (const auto& [x, y] : lines) std::cout << x << " " << y << "\n";
+  // one polyline (vertex indices in order) per line
+  for (const auto& line : lines) {
+    for (const auto& k : line) std::cout << k << " ";
+    std::cout << "\n";
+  }
 }
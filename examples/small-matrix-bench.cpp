@@ -0,0 +1,72 @@
+/**
+ * @file small-matrix-bench.cpp
+ * @brief Timing of the unrolled fixed-size kernels against the generic loops
+ * compiler option:
+ * -O3 -std=c++20 -llapack -lblas -march=native
+ */
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+#include <kspc/linalg.hpp>
+
+using complex_t = std::complex<double>;
+
+// best time in nanoseconds per call of `f` over `reps` calls
+template <class F>
+double time_per_call(F&& f, std::size_t reps) {
+  double best = std::numeric_limits<double>::max();
+  for (int trial = 0; trial < 5; ++trial) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < reps; ++r) f();
+    const auto stop = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(reps));
+  }
+  return best;
+}
+
+// prevent the compiler from discarding the result
+template <class R>
+void keep(const R& r) {
+  asm volatile("" : : "g"(&r) : "memory");
+}
+
+template <std::size_t N>
+void bench(std::mt19937& gen) {
+  std::normal_distribution<double> dist;
+  std::array<complex_t, N * N> A, B, C;
+  for (auto& x : A) x = {dist(gen), dist(gen)};
+  for (auto& x : B) x = {dist(gen), dist(gen)};
+  // the same matrices in dynamic-size containers take the generic loops
+  std::vector<complex_t> a(A.begin(), A.end()), b(B.begin(), B.end()), c(N * N);
+  constexpr auto row_major = kspc::mapping::row_major(N);
+  constexpr auto column_major = kspc::mapping::column_major(N);
+  const std::size_t reps = 4000000 / (N * N * N);
+
+  std::cout << std::setw(3) << N << std::setprecision(4);
+  // matrix_copy
+  std::cout << std::setw(10) << time_per_call([&] { kspc::matrix_copy(A, C, row_major, column_major); keep(C); }, reps)
+            << std::setw(10) << time_per_call([&] { kspc::matrix_copy(a, c, row_major, column_major); keep(c); }, reps);
+  // matrix_product
+  std::cout << std::setw(10) << time_per_call([&] { kspc::matrix_product(A, B, C, row_major, row_major, row_major); keep(C); }, reps)
+            << std::setw(10) << time_per_call([&] { kspc::matrix_product(a, b, c, row_major, row_major, row_major); keep(c); }, reps);
+  // unitary_transform
+  std::cout << std::setw(10) << time_per_call([&] { C = A; kspc::unitary_transform(C, B, row_major, row_major); keep(C); }, reps)
+            << std::setw(10) << time_per_call([&] { c = a; kspc::unitary_transform(c, b, row_major, row_major); keep(c); }, reps)
+            << "\n";
+}
+
+int main() {
+  std::mt19937 gen(0);
+  std::cout << "# time [ns] per call (complex<double>), unrolled std::array vs generic std::vector\n";
+  std::cout << "#  N      copy   copy(g)   product product(g)   unitary unitary(g)\n";
+  [&]<std::size_t... N>(std::index_sequence<N...>) {
+    (bench<N + 2>(gen), ...);
+  }(std::make_index_sequence<7>{});
+}
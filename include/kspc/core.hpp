@@ -1,5 +1,6 @@
 /// @file core.hpp
 #pragma once
+#include <algorithm>        // min, max
 #include <cassert>          // assert
 #include <cstddef>          // size_t, ptrdiff_t, nullptr_t
 #include <cstdint>          // int32_t
@@ -9,9 +10,12 @@
 #include <utility>          // move, forward, pair, swap, exchange, declval
 
 #include <complex>
-#include <iosfwd>   // basic_ostream
-#include <iterator> // begin, end, size, data
-#include <limits>   // numeric_limits
+#include <exception> // exception_ptr, current_exception, rethrow_exception
+#include <iosfwd>    // basic_ostream
+#include <iterator>  // begin, end, size, data
+#include <limits>    // numeric_limits
+#include <thread>    // thread, hardware_concurrency
+#include <vector>
 
 /// @defgroup utility Utility
 /// Utility inline variables, type aliases, type transformations and function objects
@@ -560,8 +564,12 @@ namespace kspc {
   // [x] is_input_range<R> = is_range<R> && is_input_iterator<iterator_t<R>>
 
   /// %is_input_range
+  template <typename R, typename = void>
+  struct is_input_range : std::false_type {};
+
+  /// partial specialization of `is_input_range`
   template <typename R>
-  struct is_input_range : std::conjunction<is_range<R>, is_input_iterator<iterator_t<R>>> {};
+  struct is_input_range<R, std::enable_if_t<is_range_v<R>>> : is_input_iterator<iterator_t<R>> {};
 
   /// helper variable template for `is_input_range`
   template <typename R>
@@ -651,3 +659,50 @@ namespace kspc {
 
   /// @}
 } // namespace kspc
+
+// parallel
+namespace kspc {
+  /// @addtogroup utility
+  /// @{
+
+  /// @brief call `f(first, last)` on consecutive chunks of [0, n) from up to `threads` threads
+  /// @details `threads == 0` uses `std::thread::hardware_concurrency()`. The threads are created
+  /// on every call. The calling thread takes the last chunk, so `threads == 1` (or n <= 1) runs
+  /// `f(0, n)` serially without a thread. An exception thrown by `f` is rethrown after all the
+  /// chunks have finished (the one of the first chunk if several throw), as in the serial case.
+  template <typename F>
+  void parallel_for(const std::size_t n, F&& f, unsigned threads = 0) {
+    if (threads == 0) threads = std::max(std::thread::hardware_concurrency(), 1u);
+    const std::size_t chunks = std::min<std::size_t>(threads, n);
+    if (chunks <= 1) {
+      if (n > 0) f(std::size_t(0), n);
+      return;
+    }
+    std::vector<std::exception_ptr> errors(chunks);
+    auto run = [&f, &errors, n, chunks](const std::size_t c) noexcept {
+      try {
+        f(n * c / chunks, n * (c + 1) / chunks);
+      } catch (...) {
+        errors[c] = std::current_exception();
+      }
+    };
+    {
+      std::vector<std::thread> pool;
+      // joins the started threads on every exit, also if a thread cannot be created
+      struct join_all {
+        std::vector<std::thread>& pool;
+        ~join_all() {
+          for (auto& t : pool) t.join();
+        }
+      } guard{pool};
+      pool.reserve(chunks - 1);
+      for (std::size_t c = 0; c + 1 < chunks; ++c) pool.emplace_back(run, c);
+      run(chunks - 1);
+    }
+    for (const auto& e : errors) {
+      if (e) std::rethrow_exception(e);
+    }
+  }
+
+  /// @}
+} // namespace kspc
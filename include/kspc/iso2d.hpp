@@ -1,12 +1,15 @@
 /// @file iso2d.hpp
 #pragma once
+#include <algorithm> // std::minmax, std::min
 #include <array>
-#include <cmath>    // std::hypot
-#include <iterator> // std::size
-#include <limits>   // std::numeric_limits
+#include <cmath>
+#include <iterator>  // std::size
+#include <limits>    // std::numeric_limits
+#include <thread>    // std::thread::hardware_concurrency
+#include <tuple>
 #include <utility>
 #include <vector>
-#include <kspc/core.hpp>   // not used
+#include <kspc/core.hpp>   // kspc::parallel_for
 #include <kspc/linalg.hpp> // kspc::mapping::row_major
 
 namespace kspc::iso2d {
@@ -21,22 +24,22 @@ namespace kspc::iso2d {
 
   /// @cond
   namespace detail {
-    void symmetric_grid_impl(double y1, double y2, double step, double& y, double& dy,
-                             std::size_t& ny) {
+    inline void symmetric_grid_impl(double y1, double y2, double step, double& y, double& dy,
+                                    std::size_t& ny) {
       ny = std::size_t((y2 - y1) / step) + 1;
       if (ny < 2) ny = 2;
       dy = step;
-      y = (y1 + y2 - (ny - 1) * dy) / 2.;
+      y = (y1 + y2 - static_cast<double>(ny - 1) * dy) / 2.;
     }
   } // namespace detail
   /// @endcond
 
   /// generates a grid symmetrical to the center of the given plane
-  CartesianGrid symmetric_grid(double x1, double x2, double y1, double y2, std::size_t n) {
+  inline CartesianGrid symmetric_grid(double x1, double x2, double y1, double y2, std::size_t n) {
     if (n < 2) n = 2;
     CartesianGrid g;
     g.x = x1;
-    g.dx = (x2 - x1) / (n - 1);
+    g.dx = (x2 - x1) / static_cast<double>(n - 1);
     g.nx = n;
     detail::symmetric_grid_impl(y1, y2, g.dx, g.y, g.dy, g.ny);
     return g;
@@ -51,10 +54,29 @@ namespace kspc::iso2d {
     double iso = 0.0;
     double eps = 1e-6;
     std::size_t max_iter = std::numeric_limits<std::size_t>::max();
+    /// number of threads created by each call for the sampling and the sweeps (0: hardware
+    /// concurrency); `function` must be thread-safe if not 1. An exception thrown by `function`
+    /// is rethrown on the calling thread.
+    unsigned threads = 1;
+  };
+
+  /// parameters of `isoline_cartesian_adaptive`
+  struct AdaptiveRefinement {
+    /// initial cell size in grid steps
+    std::size_t step = 8;
+    /// a cell without a sign change at its corners is still subdivided if the smallest |f| at
+    /// the corners is at most `variation` times the variation of f over the corners
+    double variation = 0.5;
+  };
+
+  /// number of the grid evaluations of `isoline_cartesian_adaptive`
+  struct AdaptiveStats {
+    std::size_t evaluations; ///< evaluations of the function on the grid
+    std::size_t saved;       ///< evaluations saved compared to the full grid
   };
 
   namespace detail {
-    double function_call(const std::array<double, 2>& v, void* data) {
+    inline double function_call(const std::array<double, 2>& v, void* data) {
       auto* params = (params_t*)data;
       return (params->function)(v, data) - params->iso;
     }
@@ -63,31 +85,33 @@ namespace kspc::iso2d {
       std::array<double, 2> v;
       const std::size_t n;
       void* data;
-      BSearchForRootFn(double x, std::size_t m, void* d) : n(m < 1 ? m : 1), data(d) {
+      double offset; // subtracted from function_call (the level of `isoline_cartesian_levels`)
+      BSearchForRootFn(double x, std::size_t m, void* d, double o = 0.)
+        : n(m < 1 ? m : 1), data(d), offset(o) {
         v[1 - n] = x;
       }
       double operator()(double y) {
         v[n] = y;
-        return function_call(v, data);
+        return function_call(v, data) - offset;
       }
     };
 
-    bool have_opposite_signs(double v1, double v2) {
+    inline bool have_opposite_signs(double v1, double v2) {
       return (v1 >= 0. and v2 < 0.) or (v1 < 0. and v2 >= 0.);
     }
 
-    double internal_div(double x1, double x2, double v1, double v2) {
+    inline double internal_div(double x1, double x2, double v1, double v2) {
       double c = v1 / (v1 - v2);
       // if (have_opposite_signs(x1, x2)) return c * x2 + (1. - c) * x1;
       // return x1 + c * (x2 - x1);
       return c * x2 + (1. - c) * x1; // Optimized for opposite signs
     }
 
-    double bsearch_for_root(double x1, double x2, double v1, double v2, BSearchForRootFn&& fn) {
+    inline double bsearch_for_root(double x1, double x2, double v1, double v2, BSearchForRootFn&& fn) {
       double xmid, vmid;
       const auto* params = (params_t*)fn.data;
       const double eps = params->eps;
-      double n = params->max_iter;
+      double n = static_cast<double>(params->max_iter);
       while (x2 - x1 > eps and n-- > 0) {
         xmid = (x1 + x2) / 2.; // Optimized for small case
         vmid = fn(xmid);
@@ -101,63 +125,320 @@ namespace kspc::iso2d {
       return internal_div(x1, x2, v1, v2);
     }
 
-    auto isoline_cartesian_impl(CartesianGrid g, void* data) {
-      assert(g.nx > 1);
-      assert(g.ny > 1);
+    /// index of no vertex
+    inline constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
 
-      std::size_t i, j;
-      std::array<double, 2> v;
+    // marching squares: the segments in each cell between the vertices on its crossed edges.
+    // A cell has 0, 2 or 4 crossed edges; a saddle (4) is resolved by the sign of the average
+    // of the corners, which tells whether the diagonal (i, j)-(i + 1, j + 1) is connected.
+    inline std::vector<std::array<std::size_t, 2>> cell_segments(const CartesianGrid& g, const std::vector<double>& f,
+                                                                 const double offset, const std::vector<std::size_t>& xv,
+                                                                 const std::vector<std::size_t>& yv) {
+      const kspc::mapping::row_major at(g.ny);
+      std::vector<std::array<std::size_t, 2>> segments;
+      for (std::size_t i = 0; i < g.nx - 1; ++i)
+        for (std::size_t j = 0; j < g.ny - 1; ++j) {
+          const std::size_t bottom = at(xv, i, j), top = at(xv, i, j + 1);
+          const std::size_t left = at(yv, i, j), right = at(yv, i + 1, j);
+          const int crossed = (bottom != npos) + (top != npos) + (left != npos) + (right != npos);
+          if (crossed == 2) {
+            std::array<std::size_t, 2> s;
+            std::size_t k = 0;
+            for (auto e : {bottom, top, left, right})
+              if (e != npos) s[k++] = e;
+            segments.push_back(s);
+          } else if (crossed == 4) {
+            const double center = (at(f, i, j) + at(f, i + 1, j) + at(f, i, j + 1) + at(f, i + 1, j + 1)) / 4. - offset;
+            if (have_opposite_signs(center, at(f, i, j) - offset)) {
+              // (i, j) and (i + 1, j + 1) are cut off
+              segments.push_back({bottom, left});
+              segments.push_back({top, right});
+            } else {
+              // (i + 1, j) and (i, j + 1) are cut off
+              segments.push_back({bottom, right});
+              segments.push_back({left, top});
+            }
+          }
+        }
+      return segments;
+    }
+
+    // chain the segments into polylines of vertex indices. Every vertex is shared by at most two
+    // segments (the cells on both sides of its edge). An open polyline runs between the
+    // boundaries of the grid; a closed one repeats its first vertex at the end.
+    inline std::vector<std::vector<std::size_t>> connect_segments(const std::size_t nvertices,
+                                                                  const std::vector<std::array<std::size_t, 2>>& segments) {
+      std::vector<std::array<std::size_t, 2>> adjacent(nvertices, {npos, npos});
+      for (const auto& [a, b] : segments) {
+        adjacent[a][adjacent[a][0] == npos ? 0 : 1] = b;
+        adjacent[b][adjacent[b][0] == npos ? 0 : 1] = a;
+      }
+      std::vector<bool> visited(nvertices, false);
+      std::vector<std::vector<std::size_t>> lines;
+      auto walk = [&](const std::size_t start) {
+        std::vector<std::size_t> line{start};
+        visited[start] = true;
+        for (std::size_t prev = npos, cur = start;;) {
+          const std::size_t next = adjacent[cur][0] != prev ? adjacent[cur][0] : adjacent[cur][1];
+          if (next == npos or (next != start and visited[next])) break;
+          line.push_back(next);
+          if (next == start) break;
+          visited[next] = true;
+          prev = cur;
+          cur = next;
+        }
+        lines.push_back(std::move(line));
+      };
+      // open polylines from their ends, then the closed ones
+      for (std::size_t k = 0; k < nvertices; ++k)
+        if (not visited[k] and adjacent[k][1] == npos) walk(k);
+      for (std::size_t k = 0; k < nvertices; ++k)
+        if (not visited[k]) walk(k);
+      return lines;
+    }
+
+    // f(i, j) at the grid points; the rows are sampled in parallel
+    inline std::vector<double> sample_grid(const CartesianGrid& g, void* data) {
+      const auto* params = (params_t*)data;
       std::vector<double> f(g.nx * g.ny);
       // row-major: i < nx, j < ny → A(i, j) = A[i * ny + j]
       const kspc::mapping::row_major at(g.ny);
-      for (i = 0, v[0] = g.x; i < g.nx; ++i, v[0] += g.dx)
-        for (j = 0, v[1] = g.y; j < g.ny; ++j, v[1] += g.dy) at(f, i, j) = function_call(v, data);
+      kspc::parallel_for(
+        g.nx,
+        [&](std::size_t first, std::size_t last) {
+          std::array<double, 2> v;
+          for (std::size_t i = first; i < last; ++i) {
+            v[0] = g.x + static_cast<double>(i) * g.dx;
+            for (std::size_t j = 0; j < g.ny; ++j) {
+              v[1] = g.y + static_cast<double>(j) * g.dy;
+              at(f, i, j) = function_call(v, data);
+            }
+          }
+        },
+        params->threads);
+      return f;
+    }
+
+    // sweep the rows [0, rows) in parallel chunks: `sweep(i, out, index)` appends the vertices
+    // on the row i to the buffer `out` of the chunk and stores their positions in `index`. The
+    // buffers are appended to `vertices` in order (and `index` is shifted accordingly), so that
+    // the result does not depend on the number of threads.
+    template <class F>
+    void parallel_sweep(const std::size_t rows, const std::size_t ny, const unsigned threads,
+                        std::vector<std::size_t>& index, std::vector<std::array<double, 2>>& vertices,
+                        F&& sweep) {
+      const unsigned hardware = threads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : threads;
+      const std::size_t chunks = std::max<std::size_t>(std::min<std::size_t>(hardware, rows), 1);
+      std::vector<std::vector<std::array<double, 2>>> buffers(chunks);
+      kspc::parallel_for(
+        chunks,
+        [&](std::size_t first, std::size_t last) {
+          for (std::size_t c = first; c < last; ++c)
+            for (std::size_t i = rows * c / chunks; i < rows * (c + 1) / chunks; ++i) sweep(i, buffers[c], index);
+        },
+        static_cast<unsigned>(chunks));
+      for (std::size_t c = 0; c < chunks; ++c) {
+        const std::size_t offset = std::size(vertices);
+        for (std::size_t k = rows * c / chunks * ny; k < rows * (c + 1) / chunks * ny; ++k)
+          if (index[k] != npos) index[k] += offset;
+        vertices.insert(vertices.end(), buffers[c].begin(), buffers[c].end());
+      }
+    }
 
+    // vertices on the crossed edges of the sampled grid f (minus `offset`), and the polylines
+    // connecting them
+    inline auto isoline_from_samples(const CartesianGrid& g, const std::vector<double>& f, void* data,
+                                     const unsigned threads, const double offset = 0.) {
+      const kspc::mapping::row_major at(g.ny);
       std::vector<std::array<double, 2>> vertices;
-      vertices.reserve(2 * g.nx * g.ny);
+      // index of the vertex on each crossed edge: xv(i, j) on (i, j)-(i + 1, j) and yv(i, j) on
+      // (i, j)-(i, j + 1)
+      std::vector<std::size_t> xv(g.nx * g.ny, npos), yv(g.nx * g.ny, npos);
       // sweep along x-axis
-      for (i = 0, v[0] = g.x; i < g.nx - 1; ++i, v[0] += g.dx)
-        for (j = 0, v[1] = g.y; j < g.ny; ++j, v[1] += g.dy) {
-          double v1 = at(f, i, j);
-          double v2 = at(f, i + 1, j);
+      parallel_sweep(g.nx - 1, g.ny, threads, xv, vertices, [&](std::size_t i, auto& out, auto& index) {
+        const double x = g.x + static_cast<double>(i) * g.dx;
+        for (std::size_t j = 0; j < g.ny; ++j) {
+          const double y = g.y + static_cast<double>(j) * g.dy;
+          double v1 = at(f, i, j) - offset;
+          double v2 = at(f, i + 1, j) - offset;
           if (have_opposite_signs(v1, v2)) {
-            double x = bsearch_for_root(v[0], v[0] + g.dx, v1, v2, BSearchForRootFn(v[1], 0, data));
-            vertices.push_back({x, v[1]});
+            at(index, i, j) = std::size(out);
+            out.push_back({bsearch_for_root(x, x + g.dx, v1, v2, BSearchForRootFn(y, 0, data, offset)), y});
           }
         }
+      });
       // sweep along y-axis
-      for (i = 0, v[0] = g.x; i < g.nx; ++i, v[0] += g.dx)
-        for (j = 0, v[1] = g.y; j < g.ny - 1; ++j, v[1] += g.dy) {
-          double v1 = at(f, i, j);
-          double v2 = at(f, i, j + 1);
+      parallel_sweep(g.nx, g.ny, threads, yv, vertices, [&](std::size_t i, auto& out, auto& index) {
+        const double x = g.x + static_cast<double>(i) * g.dx;
+        for (std::size_t j = 0; j < g.ny - 1; ++j) {
+          const double y = g.y + static_cast<double>(j) * g.dy;
+          double v1 = at(f, i, j) - offset;
+          double v2 = at(f, i, j + 1) - offset;
           if (have_opposite_signs(v1, v2)) {
-            double y = bsearch_for_root(v[1], v[1] + g.dy, v1, v2, BSearchForRootFn(v[0], 1, data));
-            vertices.push_back({v[0], y});
+            at(index, i, j) = std::size(out);
+            out.push_back({x, bsearch_for_root(y, y + g.dy, v1, v2, BSearchForRootFn(x, 1, data, offset))});
           }
         }
+      });
       vertices.shrink_to_fit();
 
-      std::vector<std::array<std::size_t, 2>> lines;
-      lines.reserve(16 * std::size(vertices));
-      const double d = std::hypot(g.dx, g.dy);
-      for (i = 0; i < std::size(vertices); ++i)
-        for (j = i + 1; j < std::size(vertices); ++j) {
-          if (std::hypot(vertices[j][0] - vertices[i][0], vertices[j][1] - vertices[i][1]) < d)
-            lines.push_back({i, j});
+      auto segments = cell_segments(g, f, offset, xv, yv);
+      auto lines = connect_segments(std::size(vertices), segments);
+      return std::make_pair(std::move(vertices), std::move(lines));
+    }
+
+    inline auto isoline_cartesian_impl(CartesianGrid g, void* data) {
+      assert(g.nx > 1);
+      assert(g.ny > 1);
+      const auto f = sample_grid(g, data);
+      return isoline_from_samples(g, f, data, ((params_t*)data)->threads);
+    }
+
+    // f(i, j) sampled only in the cells of a quadtree that may be crossed by the isoline, and
+    // interpolated bilinearly elsewhere (see `isoline_cartesian_adaptive`). Returns the number
+    // of the evaluations.
+    inline std::size_t sample_grid_adaptive(const CartesianGrid& g, void* data, const AdaptiveRefinement& r,
+                                            std::vector<double>& f) {
+      const kspc::mapping::row_major at(g.ny);
+      f.assign(g.nx * g.ny, 0.);
+      // the points whose value is known: sampled, or interpolated at the end (f itself may be
+      // NaN, so it cannot mark them)
+      std::vector<bool> known(g.nx * g.ny, false);
+      std::size_t evaluations = 0;
+      auto sample = [&](std::size_t i, std::size_t j) {
+        double& x = at(f, i, j);
+        if (not known[at(i, j)]) {
+          x = function_call({g.x + static_cast<double>(i) * g.dx, g.y + static_cast<double>(j) * g.dy}, data);
+          known[at(i, j)] = true;
+          ++evaluations;
         }
-      lines.shrink_to_fit();
+        return x;
+      };
 
-      return std::make_pair(std::move(vertices), std::move(lines));
+      // cell [i0, i1] × [j0, j1]
+      using cell = std::array<std::size_t, 4>;
+      std::vector<cell> stack, leaves;
+      const std::size_t step = std::max<std::size_t>(r.step, 1);
+      for (std::size_t i0 = 0; i0 < g.nx - 1; i0 += step)
+        for (std::size_t j0 = 0; j0 < g.ny - 1; j0 += step)
+          stack.push_back({i0, std::min(i0 + step, g.nx - 1), j0, std::min(j0 + step, g.ny - 1)});
+      auto split = [&stack](const cell& c) {
+        const auto [i0, i1, j0, j1] = c;
+        const std::size_t im = i1 - i0 > 1 ? (i0 + i1) / 2 : i1;
+        const std::size_t jm = j1 - j0 > 1 ? (j0 + j1) / 2 : j1;
+        for (const auto& [a0, a1] : {std::array{i0, im}, std::array{im, i1}})
+          for (const auto& [b0, b1] : {std::array{j0, jm}, std::array{jm, j1}})
+            if (a0 < a1 and b0 < b1) stack.push_back({a0, a1, b0, b1});
+      };
+
+      for (bool refined = true; refined;) {
+        // refine the cells with a sign change or a small value relative to the variation
+        while (not stack.empty()) {
+          const cell c = stack.back();
+          stack.pop_back();
+          const auto [i0, i1, j0, j1] = c;
+          const double v[] = {sample(i0, j0), sample(i1, j0), sample(i0, j1), sample(i1, j1)};
+          if (i1 - i0 <= 1 and j1 - j0 <= 1) continue;
+          const auto [lo, hi] = std::minmax({v[0], v[1], v[2], v[3]});
+          const bool crossed = have_opposite_signs(lo, hi);
+          const double smallest = std::min({std::abs(v[0]), std::abs(v[1]), std::abs(v[2]), std::abs(v[3])});
+          if (crossed or smallest <= r.variation * (hi - lo)) {
+            split(c);
+          } else {
+            leaves.push_back(c);
+          }
+        }
+        // a leaf whose edges were sampled by finer neighbours with the other sign is refined
+        refined = false;
+        std::vector<cell> kept;
+        for (const auto& c : leaves) {
+          const auto [i0, i1, j0, j1] = c;
+          const double v0 = at(f, i0, j0);
+          bool conflict = false;
+          for (std::size_t i = i0; i <= i1 and not conflict; ++i)
+            for (std::size_t j : {j0, j1})
+              conflict = conflict or (known[at(i, j)] and have_opposite_signs(at(f, i, j), v0));
+          for (std::size_t j = j0; j <= j1 and not conflict; ++j)
+            for (std::size_t i : {i0, i1})
+              conflict = conflict or (known[at(i, j)] and have_opposite_signs(at(f, i, j), v0));
+          if (conflict) {
+            split(c);
+            refined = true;
+          } else {
+            kept.push_back(c);
+          }
+        }
+        leaves = std::move(kept);
+      }
+
+      // the other points are interpolated in the leaves, whose corners have the same sign
+      for (const auto& [i0, i1, j0, j1] : leaves) {
+        const double v00 = at(f, i0, j0), v10 = at(f, i1, j0), v01 = at(f, i0, j1), v11 = at(f, i1, j1);
+        for (std::size_t i = i0; i <= i1; ++i)
+          for (std::size_t j = j0; j <= j1; ++j) {
+            if (known[at(i, j)]) continue;
+            known[at(i, j)] = true;
+            double& x = at(f, i, j);
+            const double s = static_cast<double>(i - i0) / static_cast<double>(i1 - i0);
+            const double t = static_cast<double>(j - j0) / static_cast<double>(j1 - j0);
+            x = (1 - s) * (1 - t) * v00 + s * (1 - t) * v10 + (1 - s) * t * v01 + s * t * v11;
+          }
+      }
+      return evaluations;
     }
   } // namespace detail
 
-  /// extract isoline
-  auto isoline_cartesian(CartesianGrid grid, function_t* fn, void* data, double iso) {
+  /// @brief extract isoline
+  /// @details Returns the vertices and the polylines (ordered vertex indices; a closed polyline
+  /// ends with its first vertex).
+  inline auto isoline_cartesian(CartesianGrid grid, function_t* fn, void* data, double iso) {
     auto* params = (params_t*)data;
     params->function = fn;
     params->iso = iso;
     return detail::isoline_cartesian_impl(grid, data);
   }
 
+  /// @brief extract isoline sampling the grid adaptively
+  /// @details Samples the grid on cells of `refinement.step` steps and subdivides recursively
+  /// (down to the grid step) only the cells which may be crossed by the isoline; the other grid
+  /// points are interpolated. The vertices and the polylines are as in `isoline_cartesian`,
+  /// and the statistics tell how many evaluations were saved. The root refinement of the
+  /// vertices is unchanged. Sampling is serial.
+  inline auto isoline_cartesian_adaptive(CartesianGrid grid, function_t* fn, void* data, double iso,
+                                         const AdaptiveRefinement& refinement = {}) {
+    assert(grid.nx > 1);
+    assert(grid.ny > 1);
+    auto* params = (params_t*)data;
+    params->function = fn;
+    params->iso = iso;
+    std::vector<double> f;
+    const std::size_t evaluations = detail::sample_grid_adaptive(grid, data, refinement, f);
+    auto [vertices, lines] = detail::isoline_from_samples(grid, f, data, params->threads);
+    return std::make_tuple(std::move(vertices), std::move(lines),
+                           AdaptiveStats{evaluations, grid.nx * grid.ny - evaluations});
+  }
+
+  /// @brief extract isolines of several levels from one sampling of the grid
+  /// @details The function is sampled once, and the vertices and the polylines of every level
+  /// in `isos` are extracted (in parallel over the levels with `params_t::threads`). The result
+  /// has one pair of vertices and polylines per level, as `isoline_cartesian`.
+  inline auto isoline_cartesian_levels(CartesianGrid grid, function_t* fn, void* data, const std::vector<double>& isos) {
+    assert(grid.nx > 1);
+    assert(grid.ny > 1);
+    auto* params = (params_t*)data;
+    params->function = fn;
+    params->iso = 0.0;
+    const auto f = detail::sample_grid(grid, data);
+    using result_t = decltype(detail::isoline_from_samples(grid, f, data, 1));
+    std::vector<result_t> results(std::size(isos));
+    kspc::parallel_for(
+      std::size(isos),
+      [&](std::size_t first, std::size_t last) {
+        for (std::size_t l = first; l < last; ++l) results[l] = detail::isoline_from_samples(grid, f, data, 1, isos[l]);
+      },
+      params->threads);
+    return results;
+  }
+
   /// @}
 } // namespace kspc::iso2d
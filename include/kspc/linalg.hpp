@@ -1,9 +1,17 @@
 /// @file linalg.hpp
 #pragma once
-#include <algorithm> // fill
+#include <algorithm> // fill, copy, max
 #include <array>
+#include <atomic>
 #include <cmath>      // sqrt, round
 #include <functional> // invoke
+#include <limits>     // numeric_limits
+#include <map>
+#include <mutex>      // mutex, lock_guard
+#include <numbers>    // pi_v
+#include <random>     // mt19937, uniform_real_distribution
+#include <tuple>      // tuple, apply
+#include <utility>    // index_sequence
 #include <vector>
 #include <kspc/core.hpp> // is_sized_range, identity_fn, conj_fn
 
@@ -64,10 +72,35 @@ namespace kspc {
   template <typename T>
   inline constexpr auto fixed_size_matrix_dim_v = isqrt(fixed_size_array_size<T>::value);
 
+  /// @cond
+  namespace detail {
+    template <typename M>
+    using member_extent_t = decltype(std::declval<const M&>().extent());
+  } // namespace detail
+  /// @endcond
+
   /// dim
   template <typename M, std::enable_if_t<is_sized_range_v<M>, std::nullptr_t> = nullptr>
-  auto dim(const M& m) -> decltype(adl_size(m)) {
-    return static_cast<decltype(adl_size(m))>(std::round(std::sqrt(adl_size(m))));
+  constexpr auto dim(const M& m) -> decltype(adl_size(m)) {
+    using size_type = decltype(adl_size(m));
+    if constexpr (is_fixed_size_array_v<M>) {
+      return static_cast<size_type>(fixed_size_matrix_dim_v<M>);
+    } else if constexpr (is_detected_v<detail::member_extent_t, M>) {
+      return static_cast<size_type>(m.extent());
+    } else {
+      return static_cast<size_type>(std::round(std::sqrt(adl_size(m))));
+    }
+  }
+
+  /// @brief matrix dimension as `std::integral_constant` if it is known at compile time
+  /// @details Loops bounded by the result are unrolled by the compiler for fixed-size matrices.
+  template <typename M, std::enable_if_t<is_sized_range_v<M>, std::nullptr_t> = nullptr>
+  constexpr auto matrix_extent(const M& m) {
+    if constexpr (is_fixed_size_array_v<M>) {
+      return std::integral_constant<std::size_t, fixed_size_matrix_dim_v<M>>{};
+    } else {
+      return static_cast<std::size_t>(kspc::dim(m));
+    }
   }
 
   /// @}
@@ -88,6 +121,10 @@ namespace kspc::mapping {
     constexpr row_major() = default;
     constexpr explicit row_major(const size_type lda) : lda_(lda) {}
 
+    /// leading dimension
+    constexpr size_type lda() const noexcept {
+      return lda_;
+    }
     constexpr size_type operator()(const size_type i, const size_type j) const noexcept {
       return lda_ * i + j;
     }
@@ -109,6 +146,10 @@ namespace kspc::mapping {
     constexpr column_major() = default;
     constexpr explicit column_major(const size_type lda) : lda_(lda) {}
 
+    /// leading dimension
+    constexpr size_type lda() const noexcept {
+      return lda_;
+    }
     constexpr size_type operator()(const size_type i, const size_type j) const noexcept {
       return i + j * lda_;
     }
@@ -147,9 +188,323 @@ namespace kspc::mapping {
   template <typename Mapping>
   transpose(Mapping) -> transpose<Mapping>;
 
+  /// @brief upper triangle of a hermitian (symmetric) matrix packed column by column
+  /// @details Same as the packed storage of LAPACK with `uplo = 'U'`. Only (i, j) with i <= j is
+  /// stored; (j, i) is its complex conjugate. An n × n matrix takes n (n + 1) / 2 elements.
+  struct packed_upper {
+    using size_type = std::size_t;
+    constexpr packed_upper() = default;
+
+    /// number of the stored elements of an n × n matrix
+    static constexpr size_type packed_size(const size_type n) noexcept {
+      return n * (n + 1) / 2;
+    }
+    /// dimension of the matrix stored in `packed_size` elements
+    static constexpr size_type dim(const size_type packed_size) noexcept {
+      return (isqrt(8 * packed_size + 1) - 1) / 2;
+    }
+    constexpr size_type operator()(const size_type i, const size_type j) const noexcept {
+      assert(i <= j);
+      return i + j * (j + 1) / 2;
+    }
+    template <typename R>
+    constexpr auto operator()(R&& r, const size_type i, const size_type j) const
+      noexcept(noexcept(std::forward<R>(r)[operator()(i, j)]))
+        -> decltype(std::forward<R>(r)[operator()(i, j)]) {
+      return std::forward<R>(r)[operator()(i, j)];
+    }
+  }; // struct packed_upper
+
   /// @}
 } // namespace kspc::mapping
 
+// matrix_view
+namespace kspc {
+  /// @cond
+  namespace detail {
+    template <typename M>
+    using member_lda_t = decltype(std::declval<const M&>().lda());
+  } // namespace detail
+  /// @endcond
+
+  /// @addtogroup matrix
+  /// @{
+
+  /// dynamic_extent
+  inline constexpr std::size_t dynamic_extent = std::numeric_limits<std::size_t>::max();
+
+  /// @brief non-owning view of an n × n matrix with the element order given by `Mapping`
+  /// @details If `Extent` is not `dynamic_extent`, the dimension is a compile-time constant and
+  /// the view is treated as a fixed-size array (see `fixed_size_array_size`). A view whose mapping
+  /// has a leading dimension larger than n (see `submatrix_view`) is a block of a larger matrix;
+  /// its elements are reached through the mapping, and begin() and end() must not be used (they
+  /// assert `is_contiguous()`).
+  template <typename T, std::size_t Extent = dynamic_extent, typename Mapping = mapping::row_major>
+  struct matrix_view {
+  private:
+    T* data_ = nullptr;
+    std::size_t n_ = Extent == dynamic_extent ? 0 : Extent;
+    Mapping mapping_{};
+
+  public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+    using iterator = T*;
+    using mapping_type = Mapping;
+
+    /// static extent (`dynamic_extent` if the dimension is given at run time)
+    static constexpr size_type static_extent = Extent;
+
+    constexpr matrix_view() noexcept = default;
+
+    /// view of N × N elements starting at `data` (static extent only)
+    template <std::size_t E = Extent, std::enable_if_t<E != dynamic_extent, std::nullptr_t> = nullptr>
+    constexpr explicit matrix_view(T* data) noexcept : data_(data), mapping_(Extent) {}
+
+    /// view of n × n elements starting at `data`
+    constexpr matrix_view(T* data, const size_type n) noexcept : data_(data), n_(n), mapping_(n) {
+      assert(Extent == dynamic_extent or n == Extent);
+    }
+
+    /// view of n × n elements starting at `data` with the given mapping
+    constexpr matrix_view(T* data, const size_type n, const Mapping& mapping) noexcept
+      : data_(data), n_(n), mapping_(mapping) {
+      assert(Extent == dynamic_extent or n == Extent);
+    }
+
+    /// view of a contiguous range of n × n elements
+    template <typename R,
+              std::enable_if_t<(not std::is_same_v<remove_cvref_t<R>, matrix_view>)
+                                 and is_detected_v<detail::adl_data_t, R&> and is_sized_range_v<R>,
+                               std::nullptr_t> = nullptr>
+    constexpr explicit matrix_view(R& r) : matrix_view(adl_data(r), kspc::dim(r)) {}
+
+    /// dimension of the matrix
+    constexpr size_type extent() const noexcept {
+      if constexpr (Extent == dynamic_extent) {
+        return n_;
+      } else {
+        return Extent;
+      }
+    }
+    constexpr const Mapping& mapping() const noexcept {
+      return mapping_;
+    }
+    constexpr T* data() const noexcept {
+      return data_;
+    }
+    /// number of elements of the matrix (n × n), not the span of a block in its parent
+    constexpr size_type size() const noexcept {
+      return extent() * extent();
+    }
+    /// true if [data(), data() + size()) holds exactly the elements of the matrix
+    constexpr bool is_contiguous() const noexcept {
+      if constexpr (is_detected_v<detail::member_lda_t, Mapping>) {
+        return mapping_.lda() == extent();
+      } else {
+        return true;
+      }
+    }
+    constexpr iterator begin() const noexcept {
+      assert(is_contiguous());
+      return data_;
+    }
+    constexpr iterator end() const noexcept {
+      assert(is_contiguous());
+      return data_ + size();
+    }
+    constexpr reference operator[](const size_type k) const noexcept {
+      return data_[k];
+    }
+    /// element (i, j) in the layout of `Mapping`
+    constexpr reference operator()(const size_type i, const size_type j) const noexcept {
+      return data_[mapping_(i, j)];
+    }
+  }; // struct matrix_view
+
+  /// deduction guide for @link matrix_view matrix_view @endlink
+  template <typename T, std::size_t N>
+  matrix_view(T (&)[N]) -> matrix_view<T, isqrt(N)>;
+
+  /// deduction guide for @link matrix_view matrix_view @endlink
+  template <typename T, std::size_t N>
+  matrix_view(std::array<T, N>&) -> matrix_view<T, isqrt(N)>;
+
+  /// deduction guide for @link matrix_view matrix_view @endlink
+  template <typename T, std::size_t N>
+  matrix_view(const std::array<T, N>&) -> matrix_view<const T, isqrt(N)>;
+
+  /// deduction guide for @link matrix_view matrix_view @endlink
+  template <typename R>
+  matrix_view(R&) -> matrix_view<std::remove_pointer_t<detail::adl_data_t<R&>>>;
+
+  /// partial specialization of `fixed_size_array_size` for a static extent
+  template <typename T, std::size_t Extent, typename Mapping>
+  struct fixed_size_array_size<matrix_view<T, Extent, Mapping>>
+    : std::integral_constant<std::size_t, Extent * Extent> {};
+
+  /// partial specialization of `fixed_size_array_size` for `dynamic_extent` (not fixed-size)
+  template <typename T, typename Mapping>
+  struct fixed_size_array_size<matrix_view<T, dynamic_extent, Mapping>> {};
+
+  /// %is_matrix_view
+  template <typename>
+  struct is_matrix_view : std::false_type {};
+
+  /// partial specialization of `is_matrix_view`
+  template <typename T, std::size_t Extent, typename Mapping>
+  struct is_matrix_view<matrix_view<T, Extent, Mapping>> : std::true_type {};
+
+  /// helper variable template for `is_matrix_view`
+  template <typename T>
+  inline constexpr bool is_matrix_view_v = is_matrix_view<remove_cvref_t<T>>::value;
+
+  /// @brief view of the n × n block of A whose top-left element is `map(i0, j0)`
+  /// @details The block keeps the leading dimension of `map`, so that it is processed in place.
+  template <typename R, typename Mapping>
+  auto submatrix_view(R& A, const Mapping& map, const std::size_t i0, const std::size_t j0, const std::size_t n) {
+    using T = std::remove_pointer_t<detail::adl_data_t<R&>>;
+    return matrix_view<T, dynamic_extent, Mapping>(adl_data(A) + map(i0, j0), n, map);
+  }
+
+  /// @overload
+  template <std::size_t N, typename R, typename Mapping>
+  auto submatrix_view(R& A, const Mapping& map, const std::size_t i0, const std::size_t j0) {
+    using T = std::remove_pointer_t<detail::adl_data_t<R&>>;
+    return matrix_view<T, N, Mapping>(adl_data(A) + map(i0, j0), N, map);
+  }
+
+  /// @}
+
+  /// @cond
+  namespace detail {
+    // leading dimension of A handed over to LAPACK as a column-major matrix
+    template <class Mat>
+    std::size_t lapack_lda(const Mat& A, const std::size_t n) {
+      if constexpr (is_matrix_view_v<Mat>) {
+        if constexpr (is_detected_v<member_lda_t, typename Mat::mapping_type>) {
+          return std::max<std::size_t>({A.mapping().lda(), n, 1});
+        }
+      }
+      return std::max<std::size_t>(n, 1);
+    }
+  } // namespace detail
+  /// @endcond
+} // namespace kspc
+
+// layout detection
+namespace kspc {
+  /// @cond
+  namespace detail {
+    template <class Mat, class T>
+    struct is_contiguous_matrix_of
+      : std::conjunction<
+          is_detected<adl_data_t, Mat&>,
+          std::is_same<remove_cvref_t<std::remove_pointer_t<adl_data_t<Mat&>>>, T>> {};
+
+    // true if `proj(A[map(i, j)])` can be handed over to LAPACK without copying, provided that
+    // `map.lda() >= n`
+    template <class Mat, class T, class M, class P>
+    inline constexpr bool is_dense_layout_v =
+      is_contiguous_matrix_of<Mat, T>::value and is_same_uncvref_v<P, identity_fn>
+      and (is_same_uncvref_v<M, mapping::row_major> or is_same_uncvref_v<M, mapping::column_major>);
+
+    // largest dimension of the fixed-size matrices handled by the fully unrolled kernels
+    inline constexpr std::size_t unrolled_matrix_max_dim = 8;
+
+    template <class Mat, class = void>
+    struct is_unrolled_matrix : std::false_type {};
+
+    template <class Mat>
+    struct is_unrolled_matrix<Mat, std::enable_if_t<is_fixed_size_array_v<Mat>>>
+      : std::bool_constant<(fixed_size_matrix_dim_v<Mat> <= unrolled_matrix_max_dim)> {};
+
+    template <class Mat>
+    inline constexpr bool is_unrolled_matrix_v = is_unrolled_matrix<remove_cvref_t<Mat>>::value;
+
+    // f(integral_constant<0>{}), ..., f(integral_constant<N - 1>{})
+    template <class F, std::size_t... I>
+    constexpr void static_for(F&& f, std::index_sequence<I...>) {
+      (f(std::integral_constant<std::size_t, I>{}), ...);
+    }
+
+    template <std::size_t N, class F>
+    constexpr void static_for(F&& f) {
+      static_for(f, std::make_index_sequence<N>{});
+    }
+
+    // f(integral_constant<0>{}) + ... + f(integral_constant<N - 1>{})
+    template <class F, std::size_t... I>
+    constexpr auto static_sum(F&& f, std::index_sequence<I...>) {
+      return (f(std::integral_constant<std::size_t, I>{}) + ...);
+    }
+
+    template <std::size_t N, class F>
+    constexpr auto static_sum(F&& f) {
+      return static_sum(f, std::make_index_sequence<N>{});
+    }
+
+    // true if copying from map1 to map2 is a transposition (row_major ↔ column_major)
+    template <class M1, class M2>
+    inline constexpr bool is_transposed_layout_v =
+      (is_same_uncvref_v<M1, mapping::row_major> and is_same_uncvref_v<M2, mapping::column_major>)
+      or (is_same_uncvref_v<M1, mapping::column_major> and is_same_uncvref_v<M2, mapping::row_major>);
+
+    // leaf size of the recursion of `blocked_matrix_copy`, and the smallest dimension for which
+    // the blocking pays off
+    inline constexpr std::size_t matrix_copy_leaf_dim = 32;
+    inline constexpr std::size_t blocked_matrix_copy_min_dim = 128;
+
+    // cache-oblivious copy of the block [i0, i1) × [j0, j1) between mismatched layouts: the
+    // longer side is halved until both the source and destination blocks of the leaf fit in L1
+    template <class InMat, class OutMat, class M1, class M2, class P1>
+    void blocked_matrix_copy(const InMat& A, OutMat& B, const M1& map1, const M2& map2, P1& proj1,
+                             const std::size_t i0, const std::size_t i1, const std::size_t j0,
+                             const std::size_t j1) {
+      if (i1 - i0 > matrix_copy_leaf_dim or j1 - j0 > matrix_copy_leaf_dim) {
+        if (i1 - i0 >= j1 - j0) {
+          const std::size_t im = i0 + (i1 - i0) / 2;
+          blocked_matrix_copy(A, B, map1, map2, proj1, i0, im, j0, j1);
+          blocked_matrix_copy(A, B, map1, map2, proj1, im, i1, j0, j1);
+        } else {
+          const std::size_t jm = j0 + (j1 - j0) / 2;
+          blocked_matrix_copy(A, B, map1, map2, proj1, i0, i1, j0, jm);
+          blocked_matrix_copy(A, B, map1, map2, proj1, i0, i1, jm, j1);
+        }
+        return;
+      }
+      // the inner loop runs along the contiguous direction of B
+      if constexpr (is_same_uncvref_v<M2, mapping::column_major>) {
+        for (std::size_t j = j0; j < j1; ++j) {
+          for (std::size_t i = i0; i < i1; ++i) B[map2(i, j)] = std::invoke(proj1, A[map1(i, j)]);
+        }
+      } else {
+        for (std::size_t i = i0; i < i1; ++i) {
+          for (std::size_t j = j0; j < j1; ++j) B[map2(i, j)] = std::invoke(proj1, A[map1(i, j)]);
+        }
+      }
+    }
+
+    // A ← A^† (or A^T for a real A) in place
+    template <class Mat>
+    void conj_transpose_in_place(Mat& A, const std::size_t n, const std::size_t lda) {
+      for (std::size_t j = 0; j < n; ++j) {
+        A[j + j * lda] = conj(A[j + j * lda]);
+        for (std::size_t i = j + 1; i < n; ++i) {
+          const auto x = conj(A[i + j * lda]);
+          A[i + j * lda] = conj(A[j + i * lda]);
+          A[j + i * lda] = x;
+        }
+      }
+    }
+  } // namespace detail
+  /// @endcond
+} // namespace kspc
+
 // clang-format off
 
 // matrix_copy
@@ -157,17 +512,35 @@ namespace kspc {
   /// @addtogroup linalg
   /// @{
 
-  /// matrix_copy
+  /// @brief matrix_copy
+  /// @details Fully unrolled for fixed-size matrices of dimension up to 8. A copy between
+  /// row-major and column-major layouts (a transposition) is blocked recursively, so that it
+  /// stays in cache for large matrices.
   template <class InMat, class OutMat, class M1, class M2, class P1 = identity_fn>
-  void matrix_copy(const InMat& A, OutMat& B, M1&& map1, M2&& map2, P1&& proj1 = {}) {
+  constexpr void matrix_copy(const InMat& A, OutMat& B, M1&& map1, M2&& map2, P1&& proj1 = {}) {
     using std::size; // for ADL
-    const std::size_t n = kspc::dim(A);
+    const auto n = kspc::matrix_extent(A);
     assert(size(A) == n * n);
     assert(size(B) == n * n);
 
-    for (std::size_t k = 0; k < n; ++k) {
-      for (std::size_t j = 0; j < n; ++j) {
-        B[map2(j, k)] = std::invoke(proj1, A[map1(j, k)]);
+    if constexpr (detail::is_unrolled_matrix_v<InMat>) {
+      constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InMat>>;
+      detail::static_for<N>([&](auto k) {
+        detail::static_for<N>([&](auto j) {
+          B[map2(j, k)] = std::invoke(proj1, A[map1(j, k)]);
+        });
+      });
+    } else {
+      if constexpr (detail::is_transposed_layout_v<M1, M2>) {
+        if (not std::is_constant_evaluated() and n >= detail::blocked_matrix_copy_min_dim) {
+          detail::blocked_matrix_copy(A, B, map1, map2, proj1, 0, n, 0, n);
+          return;
+        }
+      }
+      for (std::size_t k = 0; k < n; ++k) {
+        for (std::size_t j = 0; j < n; ++j) {
+          B[map2(j, k)] = std::invoke(proj1, A[map1(j, k)]);
+        }
       }
     }
   }
@@ -180,19 +553,95 @@ namespace kspc {
   /// @addtogroup linalg
   /// @{
 
-  /// matrix_product
+  /// @brief matrix_product
+  /// @details Fully unrolled for fixed-size matrices of dimension up to 8.
   template <class InMat1, class InMat2, class OutMat, class M1, class M2, class M3, class P1 = identity_fn, class P2 = identity_fn>
-  void matrix_product(const InMat1& A, const InMat2& B, OutMat& C, M1&& map1, M2&& map2, M3&& map3, P1&& proj1 = {}, P2&& proj2 = {}) {
+  constexpr void matrix_product(const InMat1& A, const InMat2& B, OutMat& C, M1&& map1, M2&& map2, M3&& map3, P1&& proj1 = {}, P2&& proj2 = {}) {
     using std::size; // for ADL
-    const std::size_t n = kspc::dim(A);
+    const auto n = kspc::matrix_extent(A);
     assert(size(A) == n * n);
     assert(size(B) == n * n);
     assert(size(C) == n * n);
 
-    for (std::size_t j = 0; j < n; ++j) {
-      for (std::size_t l = 0; l < n; ++l) {
-        for (std::size_t k = 0; k < n; ++k) {
-          C[map3(j, k)] += std::invoke(proj1, A[map1(j, l)]) * std::invoke(proj2, B[map2(l, k)]);
+    if constexpr (detail::is_unrolled_matrix_v<InMat1>) {
+      // The operands are loaded into local arrays, so that each element of C is written once
+      // without being reloaded in case C aliases A or B.
+      constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InMat1>>;
+      std::array<remove_cvref_t<std::invoke_result_t<P1&, range_reference_t<const InMat1>>>, N * N> a{};
+      std::array<remove_cvref_t<std::invoke_result_t<P2&, range_reference_t<const InMat2>>>, N * N> b{};
+      detail::static_for<N>([&](auto j) {
+        detail::static_for<N>([&](auto k) {
+          a[j * N + k] = std::invoke(proj1, A[map1(j, k)]);
+          b[j * N + k] = std::invoke(proj2, B[map2(j, k)]);
+        });
+      });
+      for (std::size_t j = 0; j < N; ++j) {
+        detail::static_for<N>([&](auto k) {
+          C[map3(j, k)] += detail::static_sum<N>([&](auto l) { return a[j * N + l] * b[l * N + k]; });
+        });
+      }
+    } else {
+      for (std::size_t j = 0; j < n; ++j) {
+        for (std::size_t l = 0; l < n; ++l) {
+          for (std::size_t k = 0; k < n; ++k) {
+            C[map3(j, k)] += std::invoke(proj1, A[map1(j, l)]) * std::invoke(proj2, B[map2(l, k)]);
+          }
+        }
+      }
+    }
+  }
+
+  /// @cond
+  namespace detail {
+    template <class Mat>
+    using member_prefetch_t = decltype(std::declval<Mat&>().prefetch(std::size_t(), std::size_t()));
+
+    // hint that the elements of the tile [i0, i1) × [j0, j1) of A are read soon (e.g. paged in
+    // from the file of `mapped_matrix`); a no-op for in-memory matrices
+    template <class Mat, class M>
+    void prefetch_tile(const Mat& A, const M& map, const std::size_t i0, const std::size_t i1,
+                       const std::size_t j0, const std::size_t j1) {
+      if constexpr (is_detected_v<member_prefetch_t, const Mat>) {
+        if (i0 >= i1 or j0 >= j1) return;
+        const std::size_t corners[] = {map(i0, j0), map(i0, j1 - 1), map(i1 - 1, j0), map(i1 - 1, j1 - 1)};
+        A.prefetch(*std::min_element(std::begin(corners), std::end(corners)),
+                   *std::max_element(std::begin(corners), std::end(corners)) + 1);
+      }
+    }
+  } // namespace detail
+  /// @endcond
+
+  /// @brief matrix_product (C += AB) over tiles of `tile` × `tile` elements
+  /// @details For matrices which do not fit in memory (e.g. `mapped_matrix`): the tiles of A
+  /// and the panels of B are read in order, and the next ones are prefetched while the current
+  /// tile is multiplied, so that the product streams from disk instead of swapping.
+  template <class InMat1, class InMat2, class OutMat, class M1, class M2, class M3, class P1 = identity_fn, class P2 = identity_fn>
+  void matrix_product_tiled(const InMat1& A, const InMat2& B, OutMat& C, M1&& map1, M2&& map2, M3&& map3,
+                            const std::size_t tile = 256, P1&& proj1 = {}, P2&& proj2 = {}) {
+    using std::size; // for ADL
+    const std::size_t n = kspc::dim(A);
+    assert(size(A) == n * n);
+    assert(size(B) == n * n);
+    assert(size(C) == n * n);
+    assert(tile > 0);
+
+    for (std::size_t j0 = 0; j0 < n; j0 += tile) {
+      const std::size_t j1 = std::min(n, j0 + tile);
+      for (std::size_t l0 = 0; l0 < n; l0 += tile) {
+        const std::size_t l1 = std::min(n, l0 + tile);
+        // the next tile of A and panel of B
+        const std::size_t jn0 = l1 < n ? j0 : j1;
+        const std::size_t ln0 = l1 < n ? l1 : 0;
+        detail::prefetch_tile(A, map1, jn0, std::min(n, jn0 + tile), ln0, std::min(n, ln0 + tile));
+        detail::prefetch_tile(B, map2, ln0, std::min(n, ln0 + tile), 0, n);
+        for (std::size_t k0 = 0; k0 < n; k0 += tile) {
+          const std::size_t k1 = std::min(n, k0 + tile);
+          for (std::size_t j = j0; j < j1; ++j) {
+            for (std::size_t l = l0; l < l1; ++l) {
+              const auto a = std::invoke(proj1, A[map1(j, l)]);
+              for (std::size_t k = k0; k < k1; ++k) C[map3(j, k)] += a * std::invoke(proj2, B[map2(l, k)]);
+            }
+          }
         }
       }
     }
@@ -201,13 +650,19 @@ namespace kspc {
   /// unitary_transform
   template <class InOutMat, class InMat, class Work, class M2, class M3, class P1 = conj_fn, class P2 = identity_fn, class P3 = identity_fn>
   std::enable_if_t<std::conjunction_v<is_sized_range<InOutMat>, is_sized_range<InMat>, is_sized_range<Work>>>
-  unitary_transform(InOutMat& A, const InMat& B, Work& C, M2&& map2, M3&& map3, P1&& proj1 = {}, P2&& proj2 = {}, P3&& proj3 = {}) {
+  constexpr unitary_transform(InOutMat& A, const InMat& B, Work& C, M2&& map2, M3&& map3, P1&& proj1 = {}, P2&& proj2 = {}, P3&& proj3 = {}) {
     using std::begin, std::end; // for ADL
+    const auto n = kspc::matrix_extent(A);
+    const auto map4 = mapping::row_major(n); // C is dense even if A is a block of a larger matrix
     std::fill(begin(C), end(C), 0);
     const auto map1 = mapping::transpose(map3);
-    matrix_product(B, A, C, map1, map2, map2, proj1, proj2);
-    std::fill(begin(A), end(A), 0);
-    matrix_product(C, B, A, map2, map3, map2, identity, proj3);
+    matrix_product(B, A, C, map1, map2, map4, proj1, proj2);
+    for (std::size_t j = 0; j < n; ++j) {
+      for (std::size_t k = 0; k < n; ++k) {
+        A[map2(j, k)] = 0;
+      }
+    }
+    matrix_product(C, B, A, map4, map3, map2, identity, proj3);
   }
 
   /// @overload
@@ -227,356 +682,2876 @@ namespace kspc {
     }
   }
 
+  /// @brief unitary_transform of several matrices by the same B
+  /// @details Transforms every matrix of the tuple `As` (e.g. made by `std::tie`) in one pass
+  /// over B, so that each element of B is read once for all the matrices. C is a work range of
+  /// `sizeof...(InOutMats)` stacked dense row-major n × n matrices.
+  template <class... InOutMats, class InMat, class Work, class M2, class M3, class P1 = conj_fn, class P2 = identity_fn, class P3 = identity_fn>
+  std::enable_if_t<(sizeof...(InOutMats) != 0) and (is_sized_range_v<InOutMats> and ...) and is_sized_range_v<InMat> and is_sized_range_v<Work>>
+  unitary_transform(const std::tuple<InOutMats&...>& As, const InMat& B, Work& C, M2&& map2, M3&& map3, P1&& proj1 = {}, P2&& proj2 = {}, P3&& proj3 = {}) {
+    using std::size, std::begin, std::end; // for ADL
+    using T = range_value_t<Work>;
+    constexpr std::size_t count = sizeof...(InOutMats);
+    const auto n = kspc::matrix_extent(B);
+    const std::size_t nn = n * n;
+    assert(size(B) == nn);
+    assert(size(C) == count * nn);
+
+    const auto map4 = mapping::row_major(n); // layout of each C_i
+
+    std::apply([&](auto&... A) {
+      assert(((size(A) == nn) and ...));
+      // C_i = B^† A_i
+      std::fill(begin(C), end(C), 0);
+      const auto map1 = mapping::transpose(map3);
+      for (std::size_t j = 0; j < n; ++j) {
+        for (std::size_t l = 0; l < n; ++l) {
+          const auto b = std::invoke(proj1, B[map1(j, l)]);
+          for (std::size_t k = 0; k < n; ++k) {
+            std::size_t i = 0;
+            ((C[i++ * nn + map4(j, k)] += b * std::invoke(proj2, A[map2(l, k)])), ...);
+          }
+        }
+      }
+
+      // A_i = C_i B
+      for (std::size_t j = 0; j < n; ++j) {
+        for (std::size_t k = 0; k < n; ++k) {
+          ((A[map2(j, k)] = 0), ...);
+        }
+      }
+      for (std::size_t j = 0; j < n; ++j) {
+        for (std::size_t l = 0; l < n; ++l) {
+          std::array<T, count> c;
+          for (std::size_t i = 0; i < count; ++i) c[i] = C[i * nn + map4(j, l)];
+          for (std::size_t k = 0; k < n; ++k) {
+            const auto b = std::invoke(proj3, B[map3(l, k)]);
+            std::size_t i = 0;
+            ((A[map2(j, k)] += c[i++] * b), ...);
+          }
+        }
+      }
+    }, As);
+  }
+
+  /// @overload
+  template <class... InOutMats, class InMat, class M2, class M3, class P1 = conj_fn, class P2 = identity_fn, class P3 = identity_fn>
+  std::enable_if_t<(sizeof...(InOutMats) != 0) and (is_sized_range_v<InOutMats> and ...) and is_sized_range_v<InMat> and (not is_sized_range_v<M2>)>
+  unitary_transform(const std::tuple<InOutMats&...>& As, const InMat& B, M2&& map2, M3&& map3, P1&& proj1 = {}, P2&& proj2 = {}, P3&& proj3 = {}) {
+    using InOutMat = std::tuple_element_t<0, std::tuple<InOutMats...>>;
+    using T = remove_cvref_t<std::invoke_result_t<P2&, range_reference_t<InOutMat>>>;
+    constexpr std::size_t count = sizeof...(InOutMats);
+
+    if constexpr (is_fixed_size_array_v<remove_cvref_t<InOutMat>>) {
+      constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InOutMat>>;
+      static std::array<T, count * N * N> C;
+      unitary_transform(As, B, C, map2, map3, proj1, proj2, proj3);
+    } else {
+      const std::size_t n = kspc::dim(B);
+      std::vector<T> C(count * n * n);
+      unitary_transform(As, B, C, map2, map3, proj1, proj2, proj3);
+    }
+  }
+
+  /// @brief matrix_product of matrix views in their own layouts
+  template <class T1, std::size_t E1, class L1, class T2, std::size_t E2, class L2, class T3, std::size_t E3, class L3>
+  void matrix_product(const matrix_view<T1, E1, L1>& A, const matrix_view<T2, E2, L2>& B, const matrix_view<T3, E3, L3>& C) {
+    matrix_product(A, B, C, A.mapping(), B.mapping(), C.mapping());
+  }
+
+  /// @brief unitary_transform of matrix views in their own layouts
+  template <class T1, std::size_t E1, class L1, class T2, std::size_t E2, class L2>
+  void unitary_transform(matrix_view<T1, E1, L1> A, const matrix_view<T2, E2, L2>& B) {
+    unitary_transform(A, B, A.mapping(), B.mapping());
+  }
+
   /// @}
 } // namespace kspc
 
-// general matrix linear solve
+// matrix_element
 namespace kspc {
   /// @addtogroup linalg
   /// @{
 
-  /// @cond
-  namespace detail {
-    extern "C" {
-      // double
-
-      // LU factorization
-      // http://www.netlib.org/lapack/explore-html/dd/d9a/group__double_g_ecomputational_ga0019443faea08275ca60a734d0593e60.html#ga0019443faea08275ca60a734d0593e60
-      void dgetrf_(const std::size_t& m,
-                  const std::size_t& n,
-                  double* A, // M-by-N matrix
-                  const std::size_t& lda,
-                  std::size_t* ipiv,
-                  int& info);
+  /// @brief matrix element ⟨n|D|m⟩ = Σ_ij conj(V(i, n)) D(i, j) V(j, m) in O(N^2)
+  /// @details Same as the (n, m) element of `unitary_transform(D, V, map1, map2)`, where the
+  /// columns of V are the states (e.g. the eigenvectors from `hermitian::eigen_solve`).
+  template <class InMat1, class InMat2, class M1, class M2, class P1 = conj_fn, class P2 = identity_fn, class P3 = identity_fn>
+  auto matrix_element(const InMat1& D, const InMat2& V, const std::size_t n, const std::size_t m, M1&& map1, M2&& map2, P1&& proj1 = {}, P2&& proj2 = {}, P3&& proj3 = {}) {
+    using std::size; // for ADL
+    const auto N = kspc::matrix_extent(V);
+    assert(size(D) == N * N);
+    assert(n < N and m < N);
+    using T = remove_cvref_t<decltype(std::invoke(proj1, V[map2(0, 0)]) * std::invoke(proj2, D[map1(0, 0)]))>;
+
+    T x = 0;
+    for (std::size_t j = 0; j < N; ++j) {
+      T r = 0;
+      for (std::size_t i = 0; i < N; ++i) {
+        r += std::invoke(proj1, V[map2(i, n)]) * std::invoke(proj2, D[map1(i, j)]);
+      }
+      x += r * std::invoke(proj3, V[map2(j, m)]);
+    }
+    return x;
+  }
 
-      // solve Ax = b with a general matrix A using LU factorization
-      // http://www.netlib.org/lapack/explore-html/dd/d9a/group__double_g_ecomputational_ga58e332cb1b8ab770270843221a48296d.html#ga58e332cb1b8ab770270843221a48296d
-      void dgetrs_(const char& trans,
-                  const std::size_t& n,
-                  const std::size_t& nrhs,
-                  const double* A, // N-by-N matrix
-                  const std::size_t& lda,
-                  const std::size_t* ipiv,
-                  double* b, // N-by-NRHS matrix
-                  const std::size_t& ldb,
-                  int& info);
+  /// @brief matrix elements x[m] = ⟨n|D|m⟩ for all m in O(N^2)
+  /// @details Same as the n-th row of `unitary_transform(D, V, map1, map2)`. For a hermitian D,
+  /// ⟨m|D|n⟩ = conj(x[m]).
+  template <class InMat1, class InMat2, class OutVec, class M1, class M2, class P1 = conj_fn, class P2 = identity_fn, class P3 = identity_fn>
+  std::enable_if_t<std::conjunction_v<is_sized_range<InMat1>, is_sized_range<InMat2>, is_sized_range<OutVec>>>
+  matrix_elements(const InMat1& D, const InMat2& V, const std::size_t n, OutVec& x, M1&& map1, M2&& map2, P1&& proj1 = {}, P2&& proj2 = {}, P3&& proj3 = {}) {
+    matrix_elements(std::tie(D), V, n, std::tie(x), map1, map2, proj1, proj2, proj3);
+  }
 
-      // complex double
+  /// @brief matrix elements ⟨n|D_i|m⟩ for all m of several operators D_i
+  /// @details The operators of the tuple `Ds` (e.g. made by `std::tie`) are evaluated in one pass
+  /// over V, and `xs` holds the corresponding output vectors.
+  template <class... InMats, class InMat2, class... OutVecs, class M1, class M2, class P1 = conj_fn, class P2 = identity_fn, class P3 = identity_fn>
+  std::enable_if_t<(sizeof...(InMats) != 0) and (sizeof...(InMats) == sizeof...(OutVecs))>
+  matrix_elements(const std::tuple<InMats&...>& Ds, const InMat2& V, const std::size_t n, const std::tuple<OutVecs&...>& xs, M1&& map1, M2&& map2, P1&& proj1 = {}, P2&& proj2 = {}, P3&& proj3 = {}) {
+    using std::size, std::begin, std::end; // for ADL
+    const auto N = kspc::matrix_extent(V);
+    assert(n < N);
+
+    std::apply([&](auto&... D) {
+      std::apply([&](auto&... x) {
+        assert(((size(D) == N * N) and ...));
+        assert(((size(x) == N) and ...));
+        (std::fill(begin(x), end(x), 0), ...);
+        for (std::size_t j = 0; j < N; ++j) {
+          // r_i = Σ_l conj(V(l, n)) D_i(l, j), then x_i[m] += r_i V(j, m)
+          const auto update = [&](const auto& Di, auto& xi) {
+            using T = remove_cvref_t<decltype(xi[0])>;
+            T r = 0;
+            for (std::size_t l = 0; l < N; ++l) {
+              r += std::invoke(proj1, V[map2(l, n)]) * std::invoke(proj2, Di[map1(l, j)]);
+            }
+            for (std::size_t m = 0; m < N; ++m) {
+              xi[m] += r * std::invoke(proj3, V[map2(j, m)]);
+            }
+          };
+          (update(D, x), ...);
+        }
+      }, xs);
+    }, Ds);
+  }
 
-      // LU factorization
-      void zgetrf_(const std::size_t& m,
-                  const std::size_t& n,
-                  std::complex<double>* A, // M-by-N matrix
-                  const std::size_t& lda,
-                  std::size_t* ipiv,
-                  int& info);
+  /// @}
+} // namespace kspc
 
-      // solve Ax = b with a general matrix A using LU factorization
-      void zgetrs_(const char& trans,
-                  const std::size_t& n,
-                  const std::size_t& nrhs,
-                  const std::complex<double>* A, // N-by-N matrix
-                  const std::size_t& lda,
-                  const std::size_t* ipiv,
-                  std::complex<double>* b, // N-by-NRHS matrix
-                  const std::size_t& ldb,
-                  int& info);
-    }
-  }
-  /// @endcond
+// hermitian unitary_transform
+namespace kspc::hermitian {
+  /// @addtogroup linalg
+  /// @{
 
-  /// LU factorization
-  template <class InOutMat, class OutIPiv>
-  int lu_factor(InOutMat& A, OutIPiv& ipiv) {
-    using std::size, std::data; // for ADL
-    const std::size_t n = kspc::dim(A);
-    // std::cout << n << std::endl;
+  /// @brief unitary_transform with a hermitian matrix A
+  /// @details Same as `kspc::unitary_transform`, except that only the upper triangle of A is
+  /// read and only the upper triangle of the hermitian result is computed and mirrored to the
+  /// lower one. C is a dense row-major n × n work matrix, whatever the mapping of A.
+  template <class InOutMat, class InMat, class Work, class M2, class M3, class P1 = conj_fn, class P2 = identity_fn, class P3 = identity_fn>
+  std::enable_if_t<std::conjunction_v<is_sized_range<InOutMat>, is_sized_range<InMat>, is_sized_range<Work>>>
+  unitary_transform(InOutMat& A, const InMat& B, Work& C, M2&& map2, M3&& map3, P1&& proj1 = {}, P2&& proj2 = {}, P3&& proj3 = {}) {
+    using std::size, std::begin, std::end; // for ADL
+    const auto n = kspc::matrix_extent(A);
     assert(size(A) == n * n);
-    assert(size(ipiv) == n);
+    assert(size(B) == n * n);
+    assert(size(C) == n * n);
 
-    int info;
-    if constexpr (is_complex_v<range_value_t<InOutMat>>) {
-      //      zgetrf_(m, n,      A , lda,      ipiv , info)
-      detail::zgetrf_(n, n, data(A),   n, data(ipiv), info);
-    } else {
-      //      dgetrf_(m, n,      A , lda,      ipiv , info)
-      detail::dgetrf_(n, n, data(A),   n, data(ipiv), info);
-    }
-    return info;
-  }
+    const auto map4 = mapping::row_major(n); // layout of C
 
-  /// solve Ax = b with a general matrix A using LU factorization
-  template <class InMat, class InIPiv, class InOutVec>
-  int matrix_vector_solve_with_lu_factor(const InMat& A, const InIPiv& ipiv, InOutVec& b) {
-    using std::size, std::data; // for ADL
-    const std::size_t n = kspc::dim(A);
-    // std::cout << n << std::endl;
-    assert(size(A) == n * n);
-    assert(size(ipiv) == n);
-    assert(size(b) == n);
+    // C = B^† A, where A(l, k) = conj(A(k, l)) for l > k
+    std::fill(begin(C), end(C), 0);
+    const auto map1 = mapping::transpose(map3);
+    for (std::size_t j = 0; j < n; ++j) {
+      for (std::size_t l = 0; l < n; ++l) {
+        const auto b = std::invoke(proj1, B[map1(j, l)]);
+        for (std::size_t k = 0; k < l; ++k) {
+          C[map4(j, k)] += b * kspc::conj(std::invoke(proj2, A[map2(k, l)]));
+        }
+        for (std::size_t k = l; k < n; ++k) {
+          C[map4(j, k)] += b * std::invoke(proj2, A[map2(l, k)]);
+        }
+      }
+    }
 
-    int info;
-    if constexpr (is_complex_v<range_value_t<InMat>>) {
-      //      zgetrs_(trans, n, nrhs,      A , lda,      ipiv ,      b , ldb, info)
-      detail::zgetrs_(  'N', n,    1, data(A),   n, data(ipiv), data(b),   n, info);
+    // A = C B (upper triangle), mirrored to the lower triangle
+    for (std::size_t j = 0; j < n; ++j) {
+      for (std::size_t k = j; k < n; ++k) {
+        A[map2(j, k)] = 0;
+      }
+      for (std::size_t l = 0; l < n; ++l) {
+        const auto c = C[map4(j, l)];
+        for (std::size_t k = j; k < n; ++k) {
+          A[map2(j, k)] += c * std::invoke(proj3, B[map3(l, k)]);
+        }
+      }
+      for (std::size_t k = j + 1; k < n; ++k) {
+        A[map2(k, j)] = kspc::conj(A[map2(j, k)]);
+      }
+    }
+  }
+
+  /// @overload
+  template <class InOutMat, class InMat, class M2, class M3, class P1 = conj_fn, class P2 = identity_fn, class P3 = identity_fn>
+  std::enable_if_t<is_sized_range_v<InOutMat> and is_sized_range_v<InMat> and (not is_sized_range_v<M2>)>
+  unitary_transform(InOutMat& A, const InMat& B, M2&& map2, M3&& map3, P1&& proj1 = {}, P2&& proj2 = {}, P3&& proj3 = {}) {
+    using T = remove_cvref_t<std::invoke_result_t<P2&, range_reference_t<InOutMat>>>;
+
+    if constexpr (is_fixed_size_array_v<remove_cvref_t<InOutMat>>) {
+      constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InOutMat>>;
+      static std::array<T, N * N> C;
+      hermitian::unitary_transform(A, B, C, map2, map3, proj1, proj2, proj3);
     } else {
-      //      dgetrs_(trans, n, nrhs,      A , lda,      ipiv ,      b , ldb, info)
-      detail::dgetrs_(  'N', n,    1, data(A),   n, data(ipiv), data(b),   n, info);
+      const std::size_t n = kspc::dim(A);
+      std::vector<T> C(n * n);
+      hermitian::unitary_transform(A, B, C, map2, map3, proj1, proj2, proj3);
     }
-    return info;
   }
 
-  /// solve Ax = b with a general matrix A
-  template <class InOutMat, class OutIPiv, class InOutVec>
-  std::enable_if_t<std::conjunction_v<
-    is_sized_range<InOutMat>, is_sized_range<OutIPiv>, is_sized_range<InOutVec>>, int>
-  matrix_vector_solve(InOutMat& A, OutIPiv& ipiv, InOutVec& b) {
-    int info;
-    info = lu_factor(A, ipiv);
-    if (info) return info;
-    info = matrix_vector_solve_with_lu_factor(A, ipiv, b);
-    return info;
+  /// @brief unitary_transform of several hermitian matrices by the same B
+  /// @details Combines the batching of `kspc::unitary_transform` for a tuple of matrices with the
+  /// triangular evaluation of `hermitian::unitary_transform`.
+  template <class... InOutMats, class InMat, class Work, class M2, class M3, class P1 = conj_fn, class P2 = identity_fn, class P3 = identity_fn>
+  std::enable_if_t<(sizeof...(InOutMats) != 0) and (is_sized_range_v<InOutMats> and ...) and is_sized_range_v<InMat> and is_sized_range_v<Work>>
+  unitary_transform(const std::tuple<InOutMats&...>& As, const InMat& B, Work& C, M2&& map2, M3&& map3, P1&& proj1 = {}, P2&& proj2 = {}, P3&& proj3 = {}) {
+    using std::size, std::begin, std::end; // for ADL
+    using T = range_value_t<Work>;
+    constexpr std::size_t count = sizeof...(InOutMats);
+    const auto n = kspc::matrix_extent(B);
+    const std::size_t nn = n * n;
+    assert(size(B) == nn);
+    assert(size(C) == count * nn);
+
+    const auto map4 = mapping::row_major(n); // layout of each C_i
+
+    std::apply([&](auto&... A) {
+      assert(((size(A) == nn) and ...));
+      // C_i = B^† A_i, where A_i(l, k) = conj(A_i(k, l)) for l > k
+      std::fill(begin(C), end(C), 0);
+      const auto map1 = mapping::transpose(map3);
+      for (std::size_t j = 0; j < n; ++j) {
+        for (std::size_t l = 0; l < n; ++l) {
+          const auto b = std::invoke(proj1, B[map1(j, l)]);
+          for (std::size_t k = 0; k < l; ++k) {
+            std::size_t i = 0;
+            ((C[i++ * nn + map4(j, k)] += b * kspc::conj(std::invoke(proj2, A[map2(k, l)]))), ...);
+          }
+          for (std::size_t k = l; k < n; ++k) {
+            std::size_t i = 0;
+            ((C[i++ * nn + map4(j, k)] += b * std::invoke(proj2, A[map2(l, k)])), ...);
+          }
+        }
+      }
+
+      // A_i = C_i B (upper triangle), mirrored to the lower triangle
+      for (std::size_t j = 0; j < n; ++j) {
+        for (std::size_t k = j; k < n; ++k) {
+          ((A[map2(j, k)] = 0), ...);
+        }
+        for (std::size_t l = 0; l < n; ++l) {
+          std::array<T, count> c;
+          for (std::size_t i = 0; i < count; ++i) c[i] = C[i * nn + map4(j, l)];
+          for (std::size_t k = j; k < n; ++k) {
+            const auto b = std::invoke(proj3, B[map3(l, k)]);
+            std::size_t i = 0;
+            ((A[map2(j, k)] += c[i++] * b), ...);
+          }
+        }
+        for (std::size_t k = j + 1; k < n; ++k) {
+          ((A[map2(k, j)] = kspc::conj(A[map2(j, k)])), ...);
+        }
+      }
+    }, As);
   }
 
   /// @overload
-  template <class InMat, class InOutVec, class M, class P = identity_fn>
-  std::enable_if_t<
-    is_sized_range_v<InMat> and is_sized_range_v<InOutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
-  matrix_vector_solve(const InMat& A, InOutVec& b, M&& map, P&& proj = {}) {
-    using T = remove_cvref_t<std::invoke_result_t<P&, range_reference_t<InMat>>>;
-    int info;
-
-    if constexpr (is_fixed_size_array_v<remove_cvref_t<InMat>>) {
-      constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InMat>>;
-      static std::array<T, N * N> B;
-      constexpr auto column_major = mapping::column_major(N);
-      matrix_copy(A, B, map, column_major, proj);
-      static std::array<std::size_t, N> ipiv;
+  template <class... InOutMats, class InMat, class M2, class M3, class P1 = conj_fn, class P2 = identity_fn, class P3 = identity_fn>
+  std::enable_if_t<(sizeof...(InOutMats) != 0) and (is_sized_range_v<InOutMats> and ...) and is_sized_range_v<InMat> and (not is_sized_range_v<M2>)>
+  unitary_transform(const std::tuple<InOutMats&...>& As, const InMat& B, M2&& map2, M3&& map3, P1&& proj1 = {}, P2&& proj2 = {}, P3&& proj3 = {}) {
+    using InOutMat = std::tuple_element_t<0, std::tuple<InOutMats...>>;
+    using T = remove_cvref_t<std::invoke_result_t<P2&, range_reference_t<InOutMat>>>;
+    constexpr std::size_t count = sizeof...(InOutMats);
 
-      info = matrix_vector_solve(B, ipiv, b);
+    if constexpr (is_fixed_size_array_v<remove_cvref_t<InOutMat>>) {
+      constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InOutMat>>;
+      static std::array<T, count * N * N> C;
+      hermitian::unitary_transform(As, B, C, map2, map3, proj1, proj2, proj3);
     } else {
-      const std::size_t n = kspc::dim(A);
-      std::vector<T> B(n * n);
-      const auto column_major = mapping::column_major(n);
-      matrix_copy(A, B, map, column_major, proj);
-      std::vector<std::size_t> ipiv(n);
-
-      info = matrix_vector_solve(B, ipiv, b);
+      const std::size_t n = kspc::dim(B);
+      std::vector<T> C(count * n * n);
+      hermitian::unitary_transform(As, B, C, map2, map3, proj1, proj2, proj3);
     }
+  }
 
-    return info;
+  /// @brief unitary_transform of matrix views in their own layouts with a hermitian matrix A
+  template <class T1, std::size_t E1, class L1, class T2, std::size_t E2, class L2>
+  void unitary_transform(matrix_view<T1, E1, L1> A, const matrix_view<T2, E2, L2>& B) {
+    hermitian::unitary_transform(A, B, A.mapping(), B.mapping());
   }
 
   /// @}
-} // namespace kspc
+} // namespace kspc::hermitian
 
-// hermitian matrix eigen solve
-namespace kspc::hermitian {
+// split complex
+namespace kspc {
   /// @addtogroup linalg
   /// @{
 
+  /// @brief complex numbers stored as separate planes of the real and imaginary parts
+  /// @details The kernels on this layout (`matrix_product`, `unitary_transform` and `innerp`)
+  /// work on real arrays only, so that the compiler vectorizes them without shuffling the real
+  /// and imaginary parts. Use `split` and `merge` to convert from and to the interleaved
+  /// `std::complex` layout required by LAPACK.
+  template <class T>
+  struct split_complex {
+  private:
+    std::vector<T> re_{};
+    std::vector<T> im_{};
+
+  public:
+    using value_type = std::complex<T>;
+    using real_type = T;
+    using size_type = std::size_t;
+    split_complex() = default;
+    explicit split_complex(const size_type n) : re_(n), im_(n) {}
+
+    size_type size() const noexcept {
+      return re_.size();
+    }
+    void resize(const size_type n) {
+      re_.resize(n);
+      im_.resize(n);
+    }
+    /// plane of the real parts
+    std::vector<T>& real() noexcept {
+      return re_;
+    }
+    const std::vector<T>& real() const noexcept {
+      return re_;
+    }
+    /// plane of the imaginary parts
+    std::vector<T>& imag() noexcept {
+      return im_;
+    }
+    const std::vector<T>& imag() const noexcept {
+      return im_;
+    }
+    value_type operator[](const size_type k) const noexcept {
+      return {re_[k], im_[k]};
+    }
+    void set(const size_type k, const value_type& x) noexcept {
+      re_[k] = x.real();
+      im_[k] = x.imag();
+    }
+  }; // struct split_complex
+
   /// @cond
   namespace detail {
-    extern "C" {
-      // double
+    // sign of the imaginary part under `proj` (identity or conj)
+    template <class T, class P>
+    constexpr T imag_sign() {
+      static_assert(is_same_uncvref_v<P, identity_fn> or is_same_uncvref_v<P, conj_fn>,
+                    "the projection on split_complex must be identity or conj");
+      return is_same_uncvref_v<P, conj_fn> ? T(-1) : T(1);
+    }
+  } // namespace detail
+  /// @endcond
 
-      // solve Ax = λx with a symmetric matrix A
-      void dsyev_(const char& jobz,
-                  const char& uplo,
-                  const std::size_t& n,
-                  double* A,
-                  const std::size_t& lda,
-                  double* w,
-                  double* work,
-                  const std::size_t& lwork,
-                  int& info);
+  /// split the interleaved complex range `a` into `s`
+  template <class InVec, class T>
+  void split(const InVec& a, split_complex<T>& s) {
+    using std::size, std::begin; // for ADL
+    s.resize(size(a));
+    auto first = begin(a);
+    for (std::size_t k = 0; k < s.size(); ++k, ++first) {
+      s.real()[k] = std::real(*first);
+      s.imag()[k] = std::imag(*first);
+    }
+  }
 
-      // complex double
+  /// merge `s` into the interleaved complex range `a`
+  template <class T, class OutVec>
+  void merge(const split_complex<T>& s, OutVec& a) {
+    using std::size, std::begin; // for ADL
+    assert(size(a) == s.size());
+    auto first = begin(a);
+    for (std::size_t k = 0; k < s.size(); ++k, ++first) {
+      *first = std::complex<T>(s.real()[k], s.imag()[k]);
+    }
+  }
 
-      // solve Ax = λx with a hermitian matrix A
-      void zheev_(const char& jobz,
-                  const char& uplo,
-                  const std::size_t& n,
-                  std::complex<double>* A,
-                  const std::size_t& lda,
-                  double* w,
-                  std::complex<double>* work,
-                  const std::size_t& lwork,
-                  double* rwork,
-                  int& info);
+  /// @brief Σ proj1(a_k) proj2(b_k) on the split layout (proj1 = conj by default)
+  template <class T, class P1 = conj_fn, class P2 = identity_fn>
+  std::complex<T> innerp(const split_complex<T>& a, const split_complex<T>& b, P1 = {}, P2 = {}) {
+    assert(a.size() == b.size());
+    constexpr T s1 = detail::imag_sign<T, P1>();
+    constexpr T s2 = detail::imag_sign<T, P2>();
+    const T* ar = a.real().data();
+    const T* ai = a.imag().data();
+    const T* br = b.real().data();
+    const T* bi = b.imag().data();
+    const std::size_t n = a.size();
+
+    // independent partial sums, so that the reduction is vectorized without reassociation
+    constexpr std::size_t lanes = 4;
+    std::array<T, lanes> rr{}, ii{}, ri{}, ir{};
+    std::size_t k = 0;
+    for (; k + lanes <= n; k += lanes) {
+      for (std::size_t i = 0; i < lanes; ++i) {
+        rr[i] += ar[k + i] * br[k + i];
+        ii[i] += ai[k + i] * bi[k + i];
+        ri[i] += ar[k + i] * bi[k + i];
+        ir[i] += ai[k + i] * br[k + i];
+      }
+    }
+    for (; k < n; ++k) {
+      rr[0] += ar[k] * br[k];
+      ii[0] += ai[k] * bi[k];
+      ri[0] += ar[k] * bi[k];
+      ir[0] += ai[k] * br[k];
     }
+    T re = 0, im = 0;
+    for (std::size_t i = 0; i < lanes; ++i) {
+      re += rr[i] - s1 * s2 * ii[i];
+      im += s2 * ri[i] + s1 * ir[i];
+    }
+    return {re, im};
   }
-  /// @endcond
 
-  /// solve Ax = λx with a symmetric matrix A
-  template <class InOutMat, class OutVec, class Work>
-  std::enable_if_t<std::conjunction_v<
-    is_sized_range<InOutMat>, is_sized_range<OutVec>, is_sized_range<Work>>, int>
-  eigen_solve(InOutMat& A, OutVec& w, Work& work) {
-    using std::size, std::data; // for ADL
-    const std::size_t n = kspc::dim(A);
-    // std::cout << n << std::endl;
-    assert(size(A) == n * n);
-    assert(size(w) == n);
-    assert(size(work) >= 3 * n - 1);
+  /// @brief matrix_product on the split layout
+  /// @details Vectorized over k when `map2` and `map3` are row-major.
+  template <class T, class M1, class M2, class M3, class P1 = identity_fn, class P2 = identity_fn>
+  void matrix_product(const split_complex<T>& A, const split_complex<T>& B, split_complex<T>& C, M1&& map1, M2&& map2, M3&& map3, P1&& = {}, P2&& = {}) {
+    const std::size_t n = kspc::isqrt(A.size());
+    assert(A.size() == n * n);
+    assert(B.size() == n * n);
+    assert(C.size() == n * n);
+    constexpr T s1 = detail::imag_sign<T, P1>();
+    constexpr T s2 = detail::imag_sign<T, P2>();
+    const T* ar = A.real().data();
+    const T* ai = A.imag().data();
+    const T* br = B.real().data();
+    const T* bi = B.imag().data();
+    T* cr = C.real().data();
+    T* ci = C.imag().data();
 
-    int info;
-    //      dsyev_(jobz, uplo, n,      A , lda,      w ,      work ,     lwork , info)
-    detail::dsyev_( 'V',  'U', n, data(A),   n, data(w), data(work), size(work), info);
-    return info;
+    for (std::size_t j = 0; j < n; ++j) {
+      for (std::size_t l = 0; l < n; ++l) {
+        const T xr = ar[map1(j, l)];
+        const T xi = s1 * ai[map1(j, l)];
+        for (std::size_t k = 0; k < n; ++k) {
+          const T yr = br[map2(l, k)];
+          const T yi = s2 * bi[map2(l, k)];
+          cr[map3(j, k)] += xr * yr - xi * yi;
+          ci[map3(j, k)] += xr * yi + xi * yr;
+        }
+      }
+    }
   }
 
-  /// @brief solve Ax = λx with a hermitian matrix A
-  /// @example haldane.cpp
-  template <class InOutMat, class OutVec, class Work, class RWork>
-  std::enable_if_t<std::conjunction_v<
-    is_sized_range<InOutMat>, is_sized_range<OutVec>, is_sized_range<Work>, is_sized_range<RWork>>, int>
-  eigen_solve(InOutMat& A, OutVec& w, Work& work, RWork& rwork) {
-    using std::size, std::data; // for ADL
-    const std::size_t n = kspc::dim(A);
-    // std::cout << n << std::endl;
-    assert(size(A) == n * n);
-    assert(size(w) == n);
-    assert(size(work) >= 2 * n - 1);
-    assert(size(rwork) == 3 * n - 2);
-
-    int info;
-    //      zheev_(jobz, uplo, n,      A , lda,      w ,      work ,     lwork ,      rwork , info)
-    detail::zheev_( 'V',  'U', n, data(A),   n, data(w), data(work), size(work), data(rwork), info);
-    return info;
+  /// @brief unitary_transform on the split layout: A ← B^† A B
+  /// @details C is an n × n work matrix indexed with `map2`, like A.
+  template <class T, class M2, class M3>
+  void unitary_transform(split_complex<T>& A, const split_complex<T>& B, split_complex<T>& C, M2&& map2, M3&& map3) {
+    std::fill(C.real().begin(), C.real().end(), 0);
+    std::fill(C.imag().begin(), C.imag().end(), 0);
+    const auto map1 = mapping::transpose(map3);
+    matrix_product(B, A, C, map1, map2, map2, conj);
+    std::fill(A.real().begin(), A.real().end(), 0);
+    std::fill(A.imag().begin(), A.imag().end(), 0);
+    matrix_product(C, B, A, map2, map3, map2);
   }
 
   /// @overload
-  template <class InOutMat, class OutVec, class M, class P = identity_fn>
-  std::enable_if_t<
-    is_sized_range_v<InOutMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
-  eigen_solve(InOutMat& A, OutVec& w, M&& map, P&& proj = {}) {
-    using T = remove_cvref_t<std::invoke_result_t<P&, range_reference_t<InOutMat>>>;
-    int info;
+  template <class T, class M2, class M3>
+  std::enable_if_t<not is_same_uncvref_v<M2, split_complex<T>>>
+  unitary_transform(split_complex<T>& A, const split_complex<T>& B, M2&& map2, M3&& map3) {
+    split_complex<T> C(A.size());
+    unitary_transform(A, B, C, map2, map3);
+  }
 
-    if constexpr (is_fixed_size_array_v<remove_cvref_t<InOutMat>>) {
-      constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InOutMat>>;
-      static std::array<T, N * N> B;
-      constexpr auto column_major = mapping::column_major(N);
-      matrix_copy(A, B, map, column_major, proj);
+  /// @}
+} // namespace kspc
 
-      if constexpr (is_complex_v<T>) {
-        static std::array<T, 4 * N> work;
-        static std::array<typename T::value_type, N == 0 ? 0 : 3 * N - 2> rwork;
-        info = eigen_solve(B, w, work, rwork);
+// small matrix determinant, inverse and linear solve
+namespace kspc {
+  /// @cond
+  namespace detail {
+    // largest dimension of the closed-form kernels
+    inline constexpr std::size_t closed_form_matrix_max_dim = 4;
+
+    template <class Mat, class = void>
+    struct is_closed_form_matrix : std::false_type {};
+
+    template <class Mat>
+    struct is_closed_form_matrix<Mat, std::enable_if_t<is_fixed_size_array_v<Mat>>>
+      : std::bool_constant<(fixed_size_matrix_dim_v<Mat> <= closed_form_matrix_max_dim)> {};
+
+    template <class Mat>
+    inline constexpr bool is_closed_form_matrix_v = is_closed_form_matrix<remove_cvref_t<Mat>>::value;
+
+    // adjugate adj(A) (row-major) and det(A) of the row-major N-by-N matrix a
+    template <std::size_t N, class T>
+    constexpr T adjugate(const std::array<T, N * N>& a, std::array<T, N * N>& b) {
+      if constexpr (N == 1) {
+        b[0] = 1;
+        return a[0];
+      } else if constexpr (N == 2) {
+        b = {a[3], -a[1], -a[2], a[0]};
+        return a[0] * a[3] - a[1] * a[2];
+      } else if constexpr (N == 3) {
+        b = {
+          a[4] * a[8] - a[5] * a[7], a[2] * a[7] - a[1] * a[8], a[1] * a[5] - a[2] * a[4],
+          a[5] * a[6] - a[3] * a[8], a[0] * a[8] - a[2] * a[6], a[2] * a[3] - a[0] * a[5],
+          a[3] * a[7] - a[4] * a[6], a[1] * a[6] - a[0] * a[7], a[0] * a[4] - a[1] * a[3],
+        };
+        return a[0] * b[0] + a[1] * b[3] + a[2] * b[6];
       } else {
-        static std::array<T, 6 * N> work;
-        info = eigen_solve(B, w, work);
+        static_assert(N == 4);
+        // 2-by-2 minors of the upper (s) and lower (c) two rows
+        const T s0 = a[0] * a[5] - a[4] * a[1], s1 = a[0] * a[6] - a[4] * a[2];
+        const T s2 = a[0] * a[7] - a[4] * a[3], s3 = a[1] * a[6] - a[5] * a[2];
+        const T s4 = a[1] * a[7] - a[5] * a[3], s5 = a[2] * a[7] - a[6] * a[3];
+        const T c5 = a[10] * a[15] - a[14] * a[11], c4 = a[9] * a[15] - a[13] * a[11];
+        const T c3 = a[9] * a[14] - a[13] * a[10], c2 = a[8] * a[15] - a[12] * a[11];
+        const T c1 = a[8] * a[14] - a[12] * a[10], c0 = a[8] * a[13] - a[12] * a[9];
+        b = {
+          a[5] * c5 - a[6] * c4 + a[7] * c3,  -a[1] * c5 + a[2] * c4 - a[3] * c3,
+          a[13] * s5 - a[14] * s4 + a[15] * s3, -a[9] * s5 + a[10] * s4 - a[11] * s3,
+          -a[4] * c5 + a[6] * c2 - a[7] * c1, a[0] * c5 - a[2] * c2 + a[3] * c1,
+          -a[12] * s5 + a[14] * s2 - a[15] * s1, a[8] * s5 - a[10] * s2 + a[11] * s1,
+          a[4] * c4 - a[5] * c2 + a[7] * c0,  -a[0] * c4 + a[1] * c2 - a[3] * c0,
+          a[12] * s4 - a[13] * s2 + a[15] * s0, -a[8] * s4 + a[9] * s2 - a[11] * s0,
+          -a[4] * c3 + a[5] * c1 - a[6] * c0, a[0] * c3 - a[1] * c1 + a[2] * c0,
+          -a[12] * s3 + a[13] * s1 - a[14] * s0, a[8] * s3 - a[9] * s1 + a[10] * s0,
+        };
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
       }
+    }
 
-      matrix_copy(B, A, column_major, map);
-    } else {
-      const std::size_t n = kspc::dim(A);
-      std::vector<T> B(n * n);
-      const auto column_major = mapping::column_major(n);
-      matrix_copy(A, B, map, column_major, proj);
+    // row-major copy of proj(A)
+    template <std::size_t N, class T, class InMat, class M, class P>
+    constexpr std::array<T, N * N> load_row_major(const InMat& A, M& map, P& proj) {
+      std::array<T, N * N> a{};
+      static_for<N>([&](auto i) {
+        static_for<N>([&](auto j) { a[i * N + j] = std::invoke(proj, A[map(i, j)]); });
+      });
+      return a;
+    }
+  } // namespace detail
+  /// @endcond
 
-      if constexpr (is_complex_v<T>) {
-        std::vector<T> work(4 * n);
-        std::vector<typename T::value_type> rwork(n == 0 ? 0 : 3 * n - 2);
-        info = eigen_solve(B, w, work, rwork);
-      } else {
-        std::vector<T> work(6 * n);
-        info = eigen_solve(B, w, work);
-      }
+  /// @addtogroup linalg
+  /// @{
 
-      matrix_copy(B, A, column_major, map);
-    }
+  /// @brief determinant of a fixed-size matrix of dimension up to 4 in closed form
+  template <class InMat, class M, class P = identity_fn>
+  constexpr std::enable_if_t<detail::is_closed_form_matrix_v<InMat>,
+                             remove_cvref_t<std::invoke_result_t<P&, range_reference_t<const InMat>>>>
+  determinant(const InMat& A, M&& map, P&& proj = {}) {
+    using T = remove_cvref_t<std::invoke_result_t<P&, range_reference_t<const InMat>>>;
+    constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InMat>>;
+    const auto a = detail::load_row_major<N, T>(A, map, proj);
+    std::array<T, N * N> b{};
+    return detail::adjugate<N>(a, b);
+  }
 
-    return info;
+  /// @brief B = A^{-1} of a fixed-size matrix of dimension up to 4 in closed form
+  /// @details Returns 1 (and leaves B unchanged) if A is exactly singular, otherwise 0.
+  template <class InMat, class OutMat, class M1, class M2, class P1 = identity_fn>
+  constexpr std::enable_if_t<detail::is_closed_form_matrix_v<InMat>, int>
+  inverse(const InMat& A, OutMat& B, M1&& map1, M2&& map2, P1&& proj1 = {}) {
+    using T = remove_cvref_t<std::invoke_result_t<P1&, range_reference_t<const InMat>>>;
+    constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InMat>>;
+    const auto a = detail::load_row_major<N, T>(A, map1, proj1);
+    std::array<T, N * N> b{};
+    const T det = detail::adjugate<N>(a, b);
+    if (det == T(0)) return 1;
+    detail::static_for<N>([&](auto i) {
+      detail::static_for<N>([&](auto j) { B[map2(i, j)] = b[i * N + j] / det; });
+    });
+    return 0;
+  }
+
+  /// @brief solve Ax = b with a fixed-size matrix of dimension up to 4 by x = adj(A) b / det(A)
+  /// @details No LAPACK call and no buffer. Returns 1 (and leaves b unchanged) if A is exactly
+  /// singular, otherwise 0. Unlike `matrix_vector_solve`, which stays on the pivoted LU of
+  /// LAPACK for every size, there is no pivoting, so the result loses accuracy when A is
+  /// ill-conditioned; use it where the matrices are known to be well-conditioned.
+  template <class InMat, class InOutVec, class M, class P = identity_fn>
+  constexpr std::enable_if_t<detail::is_closed_form_matrix_v<InMat> and is_sized_range_v<InOutVec>, int>
+  small_matrix_vector_solve(const InMat& A, InOutVec& b, M&& map, P&& proj = {}) {
+    using T = remove_cvref_t<std::invoke_result_t<P&, range_reference_t<const InMat>>>;
+    constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InMat>>;
+    const auto a = detail::load_row_major<N, T>(A, map, proj);
+    std::array<T, N * N> adj{};
+    const T det = detail::adjugate<N>(a, adj);
+    if (det == T(0)) return 1;
+    std::array<T, N> x{};
+    detail::static_for<N>([&](auto i) {
+      x[i] = detail::static_sum<N>([&](auto j) { return adj[i * N + j] * b[j]; }) / det;
+    });
+    detail::static_for<N>([&](auto i) { b[i] = x[i]; });
+    return 0;
+  }
+
+  /// @brief solve A_i x_i = b_i for a batch of fixed-size matrices of dimension up to 4
+  /// @details `As` and `bs` are ranges of the same size. Returns the number of singular systems,
+  /// whose right-hand sides are left unchanged.
+  template <class InMats, class InOutVecs, class M, class P = identity_fn>
+  constexpr std::enable_if_t<
+    is_sized_range_v<InMats> and is_sized_range_v<InOutVecs>
+      and detail::is_closed_form_matrix_v<range_value_t<InMats>>, std::size_t>
+  matrix_vector_solve_batched(const InMats& As, InOutVecs& bs, M&& map, P&& proj = {}) {
+    using std::size, std::begin; // for ADL
+    assert(size(As) == size(bs));
+    std::size_t singular = 0;
+    auto b = begin(bs);
+    for (const auto& A : As) {
+      if (small_matrix_vector_solve(A, *b, map, proj) != 0) ++singular;
+      ++b;
+    }
+    return singular;
   }
 
   /// @}
 } // namespace kspc
 
-// hermitian matrix eigen solve without eigenvectors
-namespace kspc::hermitian::no_evec {
+// general matrix linear solve
+namespace kspc {
   /// @addtogroup linalg
   /// @{
 
-  /// solve Ax = λx with a symmetric matrix A without eigenvectors
-  template <class InOutMat, class OutVec, class Work>
-  std::enable_if_t<std::conjunction_v<
-    is_sized_range<InOutMat>, is_sized_range<OutVec>, is_sized_range<Work>>, int>
-  eigen_solve(InOutMat& A, OutVec& w, Work& work) {
-    using std::size, std::data; // for ADL
-    const std::size_t n = kspc::dim(A);
-    // std::cout << n << std::endl;
-    assert(size(A) == n * n);
-    assert(size(w) == n);
-    assert(size(work) >= 3 * n - 1);
+  /// @cond
+  namespace detail {
+    extern "C" {
+      // double
 
-    int info;
-    //      dsyev_(jobz, uplo, n,      A , lda,      w ,      work ,     lwork , info)
-    detail::dsyev_( 'N',  'U', n, data(A),   n, data(w), data(work), size(work), info);
-    return info;
-  }
+      // LU factorization
+      // http://www.netlib.org/lapack/explore-html/dd/d9a/group__double_g_ecomputational_ga0019443faea08275ca60a734d0593e60.html#ga0019443faea08275ca60a734d0593e60
+      void dgetrf_(const std::size_t& m,
+                  const std::size_t& n,
+                  double* A, // M-by-N matrix
+                  const std::size_t& lda,
+                  std::size_t* ipiv,
+                  int& info);
 
-  /// solve Ax = λx with a hermitian matrix A without eigenvectors
-  template <class InOutMat, class OutVec, class Work, class RWork>
-  std::enable_if_t<std::conjunction_v<
-    is_sized_range<InOutMat>, is_sized_range<OutVec>, is_sized_range<Work>, is_sized_range<RWork>>, int>
-  eigen_solve(InOutMat& A, OutVec& w, Work& work, RWork& rwork) {
-    using std::size, std::data; // for ADL
-    const std::size_t n = kspc::dim(A);
-    // std::cout << n << std::endl;
-    assert(size(A) == n * n);
-    assert(size(w) == n);
-    assert(size(work) >= 2 * n - 1);
-    assert(size(rwork) == 3 * n - 2);
+      // solve Ax = b with a general matrix A using LU factorization
+      // http://www.netlib.org/lapack/explore-html/dd/d9a/group__double_g_ecomputational_ga58e332cb1b8ab770270843221a48296d.html#ga58e332cb1b8ab770270843221a48296d
+      void dgetrs_(const char& trans,
+                  const std::size_t& n,
+                  const std::size_t& nrhs,
+                  const double* A, // N-by-N matrix
+                  const std::size_t& lda,
+                  const std::size_t* ipiv,
+                  double* b, // N-by-NRHS matrix
+                  const std::size_t& ldb,
+                  int& info);
 
-    int info;
-    //      zheev_(jobz, uplo, n,      A , lda,      w ,      work ,     lwork ,      rwork , info)
-    detail::zheev_( 'N',  'U', n, data(A),   n, data(w), data(work), size(work), data(rwork), info);
-    return info;
-  }
+      // complex double
 
-  /// @overload
-  template <class InOutMat, class OutVec, class M, class P = identity_fn>
-  std::enable_if_t<
-    is_sized_range_v<InOutMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+      // LU factorization
+      void zgetrf_(const std::size_t& m,
+                  const std::size_t& n,
+                  std::complex<double>* A, // M-by-N matrix
+                  const std::size_t& lda,
+                  std::size_t* ipiv,
+                  int& info);
+
+      // solve Ax = b with a general matrix A using LU factorization
+      void zgetrs_(const char& trans,
+                  const std::size_t& n,
+                  const std::size_t& nrhs,
+                  const std::complex<double>* A, // N-by-N matrix
+                  const std::size_t& lda,
+                  const std::size_t* ipiv,
+                  std::complex<double>* b, // N-by-NRHS matrix
+                  const std::size_t& ldb,
+                  int& info);
+      // float
+
+      // LU factorization
+      void sgetrf_(const std::size_t& m,
+                  const std::size_t& n,
+                  float* A, // M-by-N matrix
+                  const std::size_t& lda,
+                  std::size_t* ipiv,
+                  int& info);
+
+      // solve Ax = b with a general matrix A using LU factorization
+      void sgetrs_(const char& trans,
+                  const std::size_t& n,
+                  const std::size_t& nrhs,
+                  const float* A, // N-by-N matrix
+                  const std::size_t& lda,
+                  const std::size_t* ipiv,
+                  float* b, // N-by-NRHS matrix
+                  const std::size_t& ldb,
+                  int& info);
+
+      // complex float
+
+      // LU factorization
+      void cgetrf_(const std::size_t& m,
+                  const std::size_t& n,
+                  std::complex<float>* A, // M-by-N matrix
+                  const std::size_t& lda,
+                  std::size_t* ipiv,
+                  int& info);
+
+      // solve Ax = b with a general matrix A using LU factorization
+      void cgetrs_(const char& trans,
+                  const std::size_t& n,
+                  const std::size_t& nrhs,
+                  const std::complex<float>* A, // N-by-N matrix
+                  const std::size_t& lda,
+                  const std::size_t* ipiv,
+                  std::complex<float>* b, // N-by-NRHS matrix
+                  const std::size_t& ldb,
+                  int& info);
+
+      // mixed precision
+
+      // solve Ax = b with a general matrix A using LU factorization in single precision and
+      // iterative refinement in double precision
+      void dsgesv_(const std::size_t& n,
+                   const std::size_t& nrhs,
+                   double* A, // N-by-N matrix
+                   const std::size_t& lda,
+                   std::size_t* ipiv,
+                   const double* b, // N-by-NRHS matrix
+                   const std::size_t& ldb,
+                   double* x, // N-by-NRHS matrix
+                   const std::size_t& ldx,
+                   double* work,
+                   float* swork,
+                   int& iter,
+                   int& info);
+
+      // complex version of dsgesv_
+      void zcgesv_(const std::size_t& n,
+                   const std::size_t& nrhs,
+                   std::complex<double>* A, // N-by-N matrix
+                   const std::size_t& lda,
+                   std::size_t* ipiv,
+                   const std::complex<double>* b, // N-by-NRHS matrix
+                   const std::size_t& ldb,
+                   std::complex<double>* x, // N-by-NRHS matrix
+                   const std::size_t& ldx,
+                   std::complex<double>* work,
+                   std::complex<float>* swork,
+                   double* rwork,
+                   int& iter,
+                   int& info);
+    }
+
+    // overloads on the value type
+
+    inline void getrf(const std::size_t& m, const std::size_t& n, float* A, const std::size_t& lda, std::size_t* ipiv, int& info) {
+      sgetrf_(m, n, A, lda, ipiv, info);
+    }
+    inline void getrf(const std::size_t& m, const std::size_t& n, double* A, const std::size_t& lda, std::size_t* ipiv, int& info) {
+      dgetrf_(m, n, A, lda, ipiv, info);
+    }
+    inline void getrf(const std::size_t& m, const std::size_t& n, std::complex<float>* A, const std::size_t& lda, std::size_t* ipiv, int& info) {
+      cgetrf_(m, n, A, lda, ipiv, info);
+    }
+    inline void getrf(const std::size_t& m, const std::size_t& n, std::complex<double>* A, const std::size_t& lda, std::size_t* ipiv, int& info) {
+      zgetrf_(m, n, A, lda, ipiv, info);
+    }
+
+    inline void getrs(const char& trans, const std::size_t& n, const std::size_t& nrhs, const float* A, const std::size_t& lda, const std::size_t* ipiv, float* b, const std::size_t& ldb, int& info) {
+      sgetrs_(trans, n, nrhs, A, lda, ipiv, b, ldb, info);
+    }
+    inline void getrs(const char& trans, const std::size_t& n, const std::size_t& nrhs, const double* A, const std::size_t& lda, const std::size_t* ipiv, double* b, const std::size_t& ldb, int& info) {
+      dgetrs_(trans, n, nrhs, A, lda, ipiv, b, ldb, info);
+    }
+    inline void getrs(const char& trans, const std::size_t& n, const std::size_t& nrhs, const std::complex<float>* A, const std::size_t& lda, const std::size_t* ipiv, std::complex<float>* b, const std::size_t& ldb, int& info) {
+      cgetrs_(trans, n, nrhs, A, lda, ipiv, b, ldb, info);
+    }
+    inline void getrs(const char& trans, const std::size_t& n, const std::size_t& nrhs, const std::complex<double>* A, const std::size_t& lda, const std::size_t* ipiv, std::complex<double>* b, const std::size_t& ldb, int& info) {
+      zgetrs_(trans, n, nrhs, A, lda, ipiv, b, ldb, info);
+    }
+  }
+  /// @endcond
+
+  /// LU factorization
+  template <class InOutMat, class OutIPiv>
+  int lu_factor(InOutMat& A, OutIPiv& ipiv) {
+    using std::size, std::data; // for ADL
+    const std::size_t n = kspc::dim(A);
+    // std::cout << n << std::endl;
+    assert(size(A) == n * n);
+    assert(size(ipiv) == n);
+
+    const std::size_t lda = detail::lapack_lda(A, n);
+    int info;
+    //      getrf(m, n,      A , lda,      ipiv , info)
+    detail::getrf(n, n, data(A), lda, data(ipiv), info);
+    return info;
+  }
+
+  /// solve Ax = b with a general matrix A using LU factorization
+  template <class InMat, class InIPiv, class InOutVec>
+  int matrix_vector_solve_with_lu_factor(const InMat& A, const InIPiv& ipiv, InOutVec& b, const char trans = 'N') {
+    using std::size, std::data; // for ADL
+    const std::size_t n = kspc::dim(A);
+    // std::cout << n << std::endl;
+    assert(size(A) == n * n);
+    assert(size(ipiv) == n);
+    assert(size(b) == n);
+
+    const std::size_t lda = detail::lapack_lda(A, n);
+    const std::size_t ldb = std::max<std::size_t>(n, 1);
+    int info;
+    //      getrs(trans, n, nrhs,      A , lda,      ipiv ,      b , ldb, info)
+    detail::getrs(trans, n,    1, data(A), lda, data(ipiv), data(b), ldb, info);
+    return info;
+  }
+
+  /// solve Ax = b with a general matrix A
+  template <class InOutMat, class OutIPiv, class InOutVec>
+  std::enable_if_t<std::conjunction_v<
+    is_sized_range<InOutMat>, is_sized_range<OutIPiv>, is_sized_range<InOutVec>>, int>
+  matrix_vector_solve(InOutMat& A, OutIPiv& ipiv, InOutVec& b) {
+    int info;
+    info = lu_factor(A, ipiv);
+    if (info) return info;
+    info = matrix_vector_solve_with_lu_factor(A, ipiv, b);
+    return info;
+  }
+
+  /// @cond
+  namespace detail {
+    // Copies A into the column-major buffer B and solves Ax = b. A dense row-major A is copied
+    // as is (without the strided transposition) and A^T x = b is solved instead.
+    template <class InMat, class Buf, class IPiv, class InOutVec, class M, class P>
+    int copy_and_solve(const InMat& A, Buf& B, IPiv& ipiv, InOutVec& b, M&& map, P&& proj) {
+      using std::begin, std::end; // for ADL
+      const std::size_t n = kspc::dim(A);
+      char trans = 'N';
+      bool copied = false;
+      if constexpr (is_dense_layout_v<const InMat, range_value_t<Buf>, M, P>) {
+        if (map.lda() == n) {
+          std::copy(begin(A), end(A), begin(B));
+          if constexpr (is_same_uncvref_v<M, mapping::row_major>) trans = 'T';
+          copied = true;
+        }
+      }
+      if (not copied) matrix_copy(A, B, map, mapping::column_major(n), proj);
+
+      const int info = lu_factor(B, ipiv);
+      if (info) return info;
+      return matrix_vector_solve_with_lu_factor(B, ipiv, b, trans);
+    }
+  } // namespace detail
+  /// @endcond
+
+  /// @overload
+  template <class InMat, class InOutVec, class M, class P = identity_fn>
+  std::enable_if_t<
+    is_sized_range_v<InMat> and is_sized_range_v<InOutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+  matrix_vector_solve(const InMat& A, InOutVec& b, M&& map, P&& proj = {}) {
+    using T = remove_cvref_t<std::invoke_result_t<P&, range_reference_t<InMat>>>;
+
+    if constexpr (is_fixed_size_array_v<remove_cvref_t<InMat>>) {
+      constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InMat>>;
+      static std::array<T, N * N> B;
+      static std::array<std::size_t, N> ipiv;
+      return detail::copy_and_solve(A, B, ipiv, b, map, proj);
+    } else {
+      const std::size_t n = kspc::dim(A);
+      std::vector<T> B(n * n);
+      std::vector<std::size_t> ipiv(n);
+      return detail::copy_and_solve(A, B, ipiv, b, map, proj);
+    }
+  }
+
+  /// @brief LU factorization of a general matrix for repeated solves
+  /// @details Holds the factorized column-major copy of A and the pivots, so that A is factorized
+  /// once and solved against any number of right-hand sides. The buffers are reused when another
+  /// matrix of the same dimension is factorized.
+  template <class T>
+  struct lu_factorization {
+  private:
+    std::size_t n_ = 0;
+    std::vector<T> a_{};
+    std::vector<std::size_t> ipiv_{};
+    char trans_ = 'N';
+    int info_ = 0;
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    lu_factorization() = default;
+    template <class InMat, class M, class P = identity_fn>
+    lu_factorization(const InMat& A, M&& map, P&& proj = {}) {
+      factor(A, map, proj);
+    }
+
+    /// matrix dimension
+    size_type dim() const noexcept {
+      return n_;
+    }
+    /// `info` of ?getrf
+    int info() const noexcept {
+      return info_;
+    }
+
+    /// factorize A
+    template <class InMat, class M, class P = identity_fn>
+    int factor(const InMat& A, M&& map, P&& proj = {}) {
+      using std::begin, std::end; // for ADL
+      n_ = kspc::dim(A);
+      a_.resize(n_ * n_);
+      ipiv_.resize(n_);
+      // A dense row-major A is copied as is and A^T x = b is solved instead.
+      trans_ = 'N';
+      bool copied = false;
+      if constexpr (detail::is_dense_layout_v<const InMat, T, M, P>) {
+        if (map.lda() == n_) {
+          std::copy(begin(A), end(A), a_.begin());
+          if constexpr (is_same_uncvref_v<M, mapping::row_major>) trans_ = 'T';
+          copied = true;
+        }
+      }
+      if (not copied) matrix_copy(A, a_, map, mapping::column_major(n_), proj);
+      info_ = lu_factor(a_, ipiv_);
+      return info_;
+    }
+
+    /// @brief solve AX = B
+    /// @details B is a vector or a column-major n-by-nrhs matrix, where nrhs = size(B) / n.
+    template <class InOutMat>
+    int solve(InOutMat& B) const {
+      using std::size, std::data; // for ADL
+      if (info_) return info_;
+      const std::size_t ld = std::max<std::size_t>(n_, 1);
+      const std::size_t nrhs = n_ == 0 ? 0 : size(B) / n_;
+      assert(size(B) == n_ * nrhs);
+
+      int info;
+      //      getrs(trans, n , nrhs,       A  , lda,       ipiv  ,      B , ldb, info)
+      detail::getrs(trans_, n_, nrhs, a_.data(),  ld, ipiv_.data(), data(B),  ld, info);
+      return info;
+    }
+  }; // struct lu_factorization
+
+  /// @}
+} // namespace kspc
+
+// mixed precision linear solve
+namespace kspc::mixed_precision {
+  /// @addtogroup linalg
+  /// @{
+
+  /// @brief solve Ax = b with a general matrix A using LU factorization in single precision
+  /// @details The solution is refined iteratively in double precision (?dsgesv/?zcgesv). If the
+  /// refinement does not converge, A is factorized in double precision instead. The value type
+  /// must be `double` or `std::complex<double>`.
+  template <class InOutMat, class OutIPiv, class InOutVec>
+  std::enable_if_t<std::conjunction_v<
+    is_sized_range<InOutMat>, is_sized_range<OutIPiv>, is_sized_range<InOutVec>>, int>
+  matrix_vector_solve(InOutMat& A, OutIPiv& ipiv, InOutVec& b) {
+    using std::size, std::data, std::begin, std::end; // for ADL
+    using T = range_value_t<InOutMat>;
+    using U = std::conditional_t<is_complex_v<T>, std::complex<float>, float>;
+    const std::size_t n = kspc::dim(A);
+    assert(size(A) == n * n);
+    assert(size(ipiv) == n);
+    assert(size(b) == n);
+
+    const std::size_t ld = std::max<std::size_t>(n, 1);
+    std::vector<T> x(n), work(n);
+    std::vector<U> swork(n * (n + 1));
+    int iter, info;
+    if constexpr (is_complex_v<T>) {
+      std::vector<double> rwork(n);
+      //      zcgesv_(n, nrhs,      A , lda,      ipiv ,      b , ldb,        x , ldx,        work ,        swork ,        rwork , iter, info)
+      detail::zcgesv_(n,    1, data(A),  ld, data(ipiv), data(b),  ld, x.data(),  ld, work.data(), swork.data(), rwork.data(), iter, info);
+    } else {
+      //      dsgesv_(n, nrhs,      A , lda,      ipiv ,      b , ldb,        x , ldx,        work ,        swork , iter, info)
+      detail::dsgesv_(n,    1, data(A),  ld, data(ipiv), data(b),  ld, x.data(),  ld, work.data(), swork.data(), iter, info);
+    }
+    if (info == 0) std::copy(x.begin(), x.end(), begin(b));
+    return info;
+  }
+
+  /// @overload
+  template <class InMat, class InOutVec, class M, class P = identity_fn>
+  std::enable_if_t<
+    is_sized_range_v<InMat> and is_sized_range_v<InOutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+  matrix_vector_solve(const InMat& A, InOutVec& b, M&& map, P&& proj = {}) {
+    using T = remove_cvref_t<std::invoke_result_t<P&, range_reference_t<InMat>>>;
+    const std::size_t n = kspc::dim(A);
+    std::vector<T> B(n * n);
+    matrix_copy(A, B, map, mapping::column_major(n), proj);
+    std::vector<std::size_t> ipiv(n);
+    return mixed_precision::matrix_vector_solve(B, ipiv, b);
+  }
+
+  /// @}
+} // namespace kspc::mixed_precision
+
+// hermitian matrix eigen solve
+namespace kspc::hermitian {
+  /// @addtogroup linalg
+  /// @{
+
+  /// @cond
+  namespace detail {
+    extern "C" {
+      // double
+
+      // solve Ax = λx with a symmetric matrix A
+      void dsyev_(const char& jobz,
+                  const char& uplo,
+                  const std::size_t& n,
+                  double* A,
+                  const std::size_t& lda,
+                  double* w,
+                  double* work,
+                  const std::size_t& lwork,
+                  int& info);
+
+      // complex double
+
+      // solve Ax = λx with a hermitian matrix A
+      void zheev_(const char& jobz,
+                  const char& uplo,
+                  const std::size_t& n,
+                  std::complex<double>* A,
+                  const std::size_t& lda,
+                  double* w,
+                  std::complex<double>* work,
+                  const std::size_t& lwork,
+                  double* rwork,
+                  int& info);
+
+      // double (divide and conquer)
+
+      // solve Ax = λx with a symmetric matrix A
+      void dsyevd_(const char& jobz,
+                   const char& uplo,
+                   const std::size_t& n,
+                   double* A,
+                   const std::size_t& lda,
+                   double* w,
+                   double* work,
+                   const std::size_t& lwork,
+                   int* iwork,
+                   const std::size_t& liwork,
+                   int& info);
+
+      // complex double (divide and conquer)
+
+      // solve Ax = λx with a hermitian matrix A
+      void zheevd_(const char& jobz,
+                   const char& uplo,
+                   const std::size_t& n,
+                   std::complex<double>* A,
+                   const std::size_t& lda,
+                   double* w,
+                   std::complex<double>* work,
+                   const std::size_t& lwork,
+                   double* rwork,
+                   const std::size_t& lrwork,
+                   int* iwork,
+                   const std::size_t& liwork,
+                   int& info);
+
+      // double (MRRR)
+
+      // solve Ax = λx for selected eigenvalues with a symmetric matrix A
+      void dsyevr_(const char& jobz,
+                   const char& range,
+                   const char& uplo,
+                   const std::size_t& n,
+                   double* A,
+                   const std::size_t& lda,
+                   const double& vl,
+                   const double& vu,
+                   const std::size_t& il,
+                   const std::size_t& iu,
+                   const double& abstol,
+                   int& m,
+                   double* w,
+                   double* Z,
+                   const std::size_t& ldz,
+                   int* isuppz,
+                   double* work,
+                   const std::size_t& lwork,
+                   int* iwork,
+                   const std::size_t& liwork,
+                   int& info);
+
+      // complex double (MRRR)
+
+      // solve Ax = λx for selected eigenvalues with a hermitian matrix A
+      void zheevr_(const char& jobz,
+                   const char& range,
+                   const char& uplo,
+                   const std::size_t& n,
+                   std::complex<double>* A,
+                   const std::size_t& lda,
+                   const double& vl,
+                   const double& vu,
+                   const std::size_t& il,
+                   const std::size_t& iu,
+                   const double& abstol,
+                   int& m,
+                   double* w,
+                   std::complex<double>* Z,
+                   const std::size_t& ldz,
+                   int* isuppz,
+                   std::complex<double>* work,
+                   const std::size_t& lwork,
+                   double* rwork,
+                   const std::size_t& lrwork,
+                   int* iwork,
+                   const std::size_t& liwork,
+                   int& info);
+      // float
+
+      // solve Ax = λx with a symmetric matrix A
+      void ssyev_(const char& jobz,
+                  const char& uplo,
+                  const std::size_t& n,
+                  float* A,
+                  const std::size_t& lda,
+                  float* w,
+                  float* work,
+                  const std::size_t& lwork,
+                  int& info);
+
+      // complex float
+
+      // solve Ax = λx with a hermitian matrix A
+      void cheev_(const char& jobz,
+                  const char& uplo,
+                  const std::size_t& n,
+                  std::complex<float>* A,
+                  const std::size_t& lda,
+                  float* w,
+                  std::complex<float>* work,
+                  const std::size_t& lwork,
+                  float* rwork,
+                  int& info);
+
+      // float (divide and conquer)
+
+      // solve Ax = λx with a symmetric matrix A
+      void ssyevd_(const char& jobz,
+                   const char& uplo,
+                   const std::size_t& n,
+                   float* A,
+                   const std::size_t& lda,
+                   float* w,
+                   float* work,
+                   const std::size_t& lwork,
+                   int* iwork,
+                   const std::size_t& liwork,
+                   int& info);
+
+      // complex float (divide and conquer)
+
+      // solve Ax = λx with a hermitian matrix A
+      void cheevd_(const char& jobz,
+                   const char& uplo,
+                   const std::size_t& n,
+                   std::complex<float>* A,
+                   const std::size_t& lda,
+                   float* w,
+                   std::complex<float>* work,
+                   const std::size_t& lwork,
+                   float* rwork,
+                   const std::size_t& lrwork,
+                   int* iwork,
+                   const std::size_t& liwork,
+                   int& info);
+
+      // float (MRRR)
+
+      // solve Ax = λx for selected eigenvalues with a symmetric matrix A
+      void ssyevr_(const char& jobz,
+                   const char& range,
+                   const char& uplo,
+                   const std::size_t& n,
+                   float* A,
+                   const std::size_t& lda,
+                   const float& vl,
+                   const float& vu,
+                   const std::size_t& il,
+                   const std::size_t& iu,
+                   const float& abstol,
+                   int& m,
+                   float* w,
+                   float* Z,
+                   const std::size_t& ldz,
+                   int* isuppz,
+                   float* work,
+                   const std::size_t& lwork,
+                   int* iwork,
+                   const std::size_t& liwork,
+                   int& info);
+
+      // complex float (MRRR)
+
+      // solve Ax = λx for selected eigenvalues with a hermitian matrix A
+      void cheevr_(const char& jobz,
+                   const char& range,
+                   const char& uplo,
+                   const std::size_t& n,
+                   std::complex<float>* A,
+                   const std::size_t& lda,
+                   const float& vl,
+                   const float& vu,
+                   const std::size_t& il,
+                   const std::size_t& iu,
+                   const float& abstol,
+                   int& m,
+                   float* w,
+                   std::complex<float>* Z,
+                   const std::size_t& ldz,
+                   int* isuppz,
+                   std::complex<float>* work,
+                   const std::size_t& lwork,
+                   float* rwork,
+                   const std::size_t& lrwork,
+                   int* iwork,
+                   const std::size_t& liwork,
+                   int& info);
+
+      // packed storage
+
+      // solve Ax = λx with a symmetric matrix A in packed storage
+      void sspev_(const char& jobz,
+                  const char& uplo,
+                  const std::size_t& n,
+                  float* AP,
+                  float* w,
+                  float* Z,
+                  const std::size_t& ldz,
+                  float* work,
+                  int& info);
+
+      // solve Ax = λx with a symmetric matrix A in packed storage
+      void dspev_(const char& jobz,
+                  const char& uplo,
+                  const std::size_t& n,
+                  double* AP,
+                  double* w,
+                  double* Z,
+                  const std::size_t& ldz,
+                  double* work,
+                  int& info);
+
+      // solve Ax = λx with a hermitian matrix A in packed storage
+      void chpev_(const char& jobz,
+                  const char& uplo,
+                  const std::size_t& n,
+                  std::complex<float>* AP,
+                  float* w,
+                  std::complex<float>* Z,
+                  const std::size_t& ldz,
+                  std::complex<float>* work,
+                  float* rwork,
+                  int& info);
+
+      // solve Ax = λx with a hermitian matrix A in packed storage
+      void zhpev_(const char& jobz,
+                  const char& uplo,
+                  const std::size_t& n,
+                  std::complex<double>* AP,
+                  double* w,
+                  std::complex<double>* Z,
+                  const std::size_t& ldz,
+                  std::complex<double>* work,
+                  double* rwork,
+                  int& info);
+    }
+
+    // overloads on the value type
+
+    inline void syev(const char& jobz, const char& uplo, const std::size_t& n, float* A, const std::size_t& lda, float* w, float* work, const std::size_t& lwork, int& info) {
+      ssyev_(jobz, uplo, n, A, lda, w, work, lwork, info);
+    }
+    inline void syev(const char& jobz, const char& uplo, const std::size_t& n, double* A, const std::size_t& lda, double* w, double* work, const std::size_t& lwork, int& info) {
+      dsyev_(jobz, uplo, n, A, lda, w, work, lwork, info);
+    }
+    inline void heev(const char& jobz, const char& uplo, const std::size_t& n, std::complex<float>* A, const std::size_t& lda, float* w, std::complex<float>* work, const std::size_t& lwork, float* rwork, int& info) {
+      cheev_(jobz, uplo, n, A, lda, w, work, lwork, rwork, info);
+    }
+    inline void heev(const char& jobz, const char& uplo, const std::size_t& n, std::complex<double>* A, const std::size_t& lda, double* w, std::complex<double>* work, const std::size_t& lwork, double* rwork, int& info) {
+      zheev_(jobz, uplo, n, A, lda, w, work, lwork, rwork, info);
+    }
+
+    inline void syevd(const char& jobz, const char& uplo, const std::size_t& n, float* A, const std::size_t& lda, float* w, float* work, const std::size_t& lwork, int* iwork, const std::size_t& liwork, int& info) {
+      ssyevd_(jobz, uplo, n, A, lda, w, work, lwork, iwork, liwork, info);
+    }
+    inline void syevd(const char& jobz, const char& uplo, const std::size_t& n, double* A, const std::size_t& lda, double* w, double* work, const std::size_t& lwork, int* iwork, const std::size_t& liwork, int& info) {
+      dsyevd_(jobz, uplo, n, A, lda, w, work, lwork, iwork, liwork, info);
+    }
+    inline void heevd(const char& jobz, const char& uplo, const std::size_t& n, std::complex<float>* A, const std::size_t& lda, float* w, std::complex<float>* work, const std::size_t& lwork, float* rwork, const std::size_t& lrwork, int* iwork, const std::size_t& liwork, int& info) {
+      cheevd_(jobz, uplo, n, A, lda, w, work, lwork, rwork, lrwork, iwork, liwork, info);
+    }
+    inline void heevd(const char& jobz, const char& uplo, const std::size_t& n, std::complex<double>* A, const std::size_t& lda, double* w, std::complex<double>* work, const std::size_t& lwork, double* rwork, const std::size_t& lrwork, int* iwork, const std::size_t& liwork, int& info) {
+      zheevd_(jobz, uplo, n, A, lda, w, work, lwork, rwork, lrwork, iwork, liwork, info);
+    }
+
+    // NOTE: `vl`, `vu` and `abstol` are taken in double precision for all the value types
+    inline void syevr(const char& jobz, const char& range, const char& uplo, const std::size_t& n, float* A, const std::size_t& lda, const double& vl, const double& vu, const std::size_t& il, const std::size_t& iu, const double& abstol, int& m, float* w, float* Z, const std::size_t& ldz, int* isuppz, float* work, const std::size_t& lwork, int* iwork, const std::size_t& liwork, int& info) {
+      ssyevr_(jobz, range, uplo, n, A, lda, static_cast<float>(vl), static_cast<float>(vu), il, iu, static_cast<float>(abstol), m, w, Z, ldz, isuppz, work, lwork, iwork, liwork, info);
+    }
+    inline void syevr(const char& jobz, const char& range, const char& uplo, const std::size_t& n, double* A, const std::size_t& lda, const double& vl, const double& vu, const std::size_t& il, const std::size_t& iu, const double& abstol, int& m, double* w, double* Z, const std::size_t& ldz, int* isuppz, double* work, const std::size_t& lwork, int* iwork, const std::size_t& liwork, int& info) {
+      dsyevr_(jobz, range, uplo, n, A, lda, vl, vu, il, iu, abstol, m, w, Z, ldz, isuppz, work, lwork, iwork, liwork, info);
+    }
+    inline void heevr(const char& jobz, const char& range, const char& uplo, const std::size_t& n, std::complex<float>* A, const std::size_t& lda, const double& vl, const double& vu, const std::size_t& il, const std::size_t& iu, const double& abstol, int& m, float* w, std::complex<float>* Z, const std::size_t& ldz, int* isuppz, std::complex<float>* work, const std::size_t& lwork, float* rwork, const std::size_t& lrwork, int* iwork, const std::size_t& liwork, int& info) {
+      cheevr_(jobz, range, uplo, n, A, lda, static_cast<float>(vl), static_cast<float>(vu), il, iu, static_cast<float>(abstol), m, w, Z, ldz, isuppz, work, lwork, rwork, lrwork, iwork, liwork, info);
+    }
+    inline void heevr(const char& jobz, const char& range, const char& uplo, const std::size_t& n, std::complex<double>* A, const std::size_t& lda, const double& vl, const double& vu, const std::size_t& il, const std::size_t& iu, const double& abstol, int& m, double* w, std::complex<double>* Z, const std::size_t& ldz, int* isuppz, std::complex<double>* work, const std::size_t& lwork, double* rwork, const std::size_t& lrwork, int* iwork, const std::size_t& liwork, int& info) {
+      zheevr_(jobz, range, uplo, n, A, lda, vl, vu, il, iu, abstol, m, w, Z, ldz, isuppz, work, lwork, rwork, lrwork, iwork, liwork, info);
+    }
+
+    inline void spev(const char& jobz, const char& uplo, const std::size_t& n, float* AP, float* w, float* Z, const std::size_t& ldz, float* work, int& info) {
+      sspev_(jobz, uplo, n, AP, w, Z, ldz, work, info);
+    }
+    inline void spev(const char& jobz, const char& uplo, const std::size_t& n, double* AP, double* w, double* Z, const std::size_t& ldz, double* work, int& info) {
+      dspev_(jobz, uplo, n, AP, w, Z, ldz, work, info);
+    }
+    inline void hpev(const char& jobz, const char& uplo, const std::size_t& n, std::complex<float>* AP, float* w, std::complex<float>* Z, const std::size_t& ldz, std::complex<float>* work, float* rwork, int& info) {
+      chpev_(jobz, uplo, n, AP, w, Z, ldz, work, rwork, info);
+    }
+    inline void hpev(const char& jobz, const char& uplo, const std::size_t& n, std::complex<double>* AP, double* w, std::complex<double>* Z, const std::size_t& ldz, std::complex<double>* work, double* rwork, int& info) {
+      zhpev_(jobz, uplo, n, AP, w, Z, ldz, work, rwork, info);
+    }
+
+    template <class T>
+    struct real_value {
+      using type = T;
+    };
+
+    template <class T>
+    struct real_value<std::complex<T>> {
+      using type = T;
+    };
+
+    template <class T>
+    using real_value_t = typename real_value<T>::type;
+  }
+  /// @endcond
+
+  /// @brief algorithm of `eigen_solve`
+  /// @details `automatic` selects `qr` below n = 24 and `divide_and_conquer` otherwise (see
+  /// `resolve_algorithm`).
+  enum class algorithm {
+    automatic,          ///< selected by the dimension
+    qr,                 ///< implicit QL/QR (?syev/?heev)
+    divide_and_conquer, ///< divide and conquer (?syevd/?heevd)
+    mrrr,               ///< multiple relatively robust representations (?syevr/?heevr)
+  };
+
+  /// @cond
+  namespace detail {
+    inline constexpr std::size_t automatic_algorithm_threshold = 24;
+  } // namespace detail
+  /// @endcond
+
+  /// @brief the driver used by `eigen_solve` for `algo` and an n-by-n matrix
+  /// @details `automatic` follows eigen-bench.cpp (single-threaded OpenBLAS, complex<double>):
+  /// `qr` is the fastest below n = 24 and `divide_and_conquer` from there on. `mrrr` is within
+  /// a few percent of `divide_and_conquer` for n >= 128 (ahead or behind depending on the run),
+  /// which does not pay for its weaker guarantee of orthogonality of the eigenvectors in tight
+  /// clusters of eigenvalues, so it is used only if requested.
+  inline algorithm resolve_algorithm(const algorithm algo, const std::size_t n) noexcept {
+    if (algo != algorithm::automatic) return algo;
+    return n < detail::automatic_algorithm_threshold ? algorithm::qr
+                                                     : algorithm::divide_and_conquer;
+  }
+
+  /// @brief workspace for `eigen_solve`
+  /// @details The optimal sizes of the work arrays are queried from LAPACK (`lwork = -1`) once
+  /// per dimension and driver. The buffers only grow, so that repeated diagonalizations of the
+  /// same dimension never reallocate.
+  template <class T>
+  struct eigen_workspace {
+  private:
+    std::size_t n_ = 0;
+    bool qr_ = false;   // prepared for ?syev/?heev
+    bool dc_ = false;   // prepared for ?syevd/?heevd
+    bool mrrr_ = false; // prepared for ?syevr/?heevr
+    std::vector<T> a_{};
+    std::vector<T> z_{};
+    std::vector<T> work_{};
+    std::vector<detail::real_value_t<T>> rwork_{};
+    std::vector<int> iwork_{};
+    std::vector<int> isuppz_{};
+
+    template <class V>
+    static void grow(V& v, const std::size_t n) {
+      if (std::size(v) < n) v.resize(n);
+    }
+
+    void prepare(const std::size_t n) {
+      if (n == n_) return;
+      n_ = n;
+      qr_ = dc_ = mrrr_ = false;
+      a_.resize(n * n);
+    }
+
+  public:
+    using value_type = T;
+    using real_type = detail::real_value_t<T>;
+    using size_type = std::size_t;
+    eigen_workspace() = default;
+    explicit eigen_workspace(const size_type n) { reserve(n); }
+
+    /// matrix dimension for which the workspace is prepared
+    size_type dim() const noexcept {
+      return n_;
+    }
+    /// column-major buffer used by the overloads with a mapping
+    std::vector<T>& matrix() noexcept {
+      return a_;
+    }
+    /// column-major buffer for the eigenvectors computed by ?syevr/?heevr
+    std::vector<T>& eigenvectors() noexcept {
+      return z_;
+    }
+    std::vector<T>& work() noexcept {
+      return work_;
+    }
+    std::vector<real_type>& rwork() noexcept {
+      return rwork_;
+    }
+    std::vector<int>& iwork() noexcept {
+      return iwork_;
+    }
+    std::vector<int>& isuppz() noexcept {
+      return isuppz_;
+    }
+
+    /// prepare the buffers of ?syev/?heev for an n-by-n matrix
+    void reserve(const size_type n) {
+      prepare(n);
+      if (qr_) return;
+      qr_ = true;
+      const std::size_t lda = std::max<std::size_t>(n, 1);
+      const auto query = static_cast<std::size_t>(-1); // lwork = -1: workspace query
+      T opt{};
+      real_type w{};
+      int info;
+      if constexpr (is_complex_v<T>) {
+        grow(rwork_, n == 0 ? 0 : 3 * n - 2);
+        //      heev(jobz, uplo, n,        A , lda,  w , work , lwork,       rwork , info)
+        detail::heev( 'V',  'U', n, a_.data(), lda, &w, &opt, query, rwork_.data(), info);
+      } else {
+        //      syev(jobz, uplo, n,        A , lda,  w , work , lwork, info)
+        detail::syev( 'V',  'U', n, a_.data(), lda, &w, &opt, query, info);
+      }
+      const auto minimum = is_complex_v<T> ? std::max<std::size_t>(2 * n, 2) - 1
+                                           : std::max<std::size_t>(3 * n, 2) - 1;
+      grow(work_, std::max(info == 0 ? static_cast<std::size_t>(std::real(opt)) : 0, minimum));
+    }
+
+    /// prepare the buffers of ?syevd/?heevd for an n-by-n matrix
+    void reserve_dc(const size_type n) {
+      prepare(n);
+      if (dc_) return;
+      dc_ = true;
+      const std::size_t lda = std::max<std::size_t>(n, 1);
+      const auto query = static_cast<std::size_t>(-1); // lwork = -1: workspace query
+      T opt{};
+      real_type ropt{}, w{};
+      int iopt{}, info;
+      if constexpr (is_complex_v<T>) {
+        //      heevd(jobz, uplo, n,        A , lda,  w , work , lwork,  rwork , lrwork,  iwork , liwork, info)
+        detail::heevd( 'V',  'U', n, a_.data(), lda, &w, &opt, query, &ropt,   query, &iopt,  query, info);
+        grow(rwork_, std::max(info == 0 ? static_cast<std::size_t>(ropt) : 0, 1 + 5 * n + 2 * n * n));
+      } else {
+        //      syevd(jobz, uplo, n,        A , lda,  w , work , lwork,  iwork , liwork, info)
+        detail::syevd( 'V',  'U', n, a_.data(), lda, &w, &opt, query, &iopt,  query, info);
+      }
+      const auto minimum = is_complex_v<T> ? std::max<std::size_t>(2 * n + n * n, 1) : 1 + 6 * n + 2 * n * n;
+      grow(work_, std::max(info == 0 ? static_cast<std::size_t>(std::real(opt)) : 0, minimum));
+      grow(iwork_, std::max(info == 0 ? static_cast<std::size_t>(iopt) : 0, 3 + 5 * n));
+    }
+
+    /// prepare the buffers of ?syevr/?heevr for an n-by-n matrix
+    void reserve_mrrr(const size_type n) {
+      prepare(n);
+      if (mrrr_) return;
+      mrrr_ = true;
+      z_.resize(n * n);
+      grow(isuppz_, 2 * std::max<std::size_t>(n, 1));
+      const std::size_t lda = std::max<std::size_t>(n, 1);
+      const auto query = static_cast<std::size_t>(-1); // lwork = -1: workspace query
+      T opt{};
+      real_type ropt{}, w{};
+      int iopt{}, m, info;
+      if constexpr (is_complex_v<T>) {
+        //      heevr(jobz, range, uplo, n,        A , lda, vl, vu, il, iu, abstol, m,  w ,        Z , ldz,            isuppz , work , lwork,   rwork , lrwork,   iwork , liwork, info)
+        detail::heevr( 'V',   'A',  'U', n, a_.data(), lda,  0,  0,  1,  1,      0, m, &w, z_.data(), lda, isuppz_.data(), &opt, query, &ropt,   query, &iopt,  query, info);
+        grow(rwork_, std::max(info == 0 ? static_cast<std::size_t>(ropt) : 0, 24 * lda));
+      } else {
+        //      syevr(jobz, range, uplo, n,        A , lda, vl, vu, il, iu, abstol, m,  w ,        Z , ldz,            isuppz , work , lwork, iwork , liwork, info)
+        detail::syevr( 'V',   'A',  'U', n, a_.data(), lda,  0,  0,  1,  1,      0, m, &w, z_.data(), lda, isuppz_.data(), &opt, query, &iopt,  query, info);
+      }
+      const auto minimum = (is_complex_v<T> ? 2 : 26) * lda;
+      grow(work_, std::max(info == 0 ? static_cast<std::size_t>(std::real(opt)) : 0, minimum));
+      grow(iwork_, std::max(info == 0 ? static_cast<std::size_t>(iopt) : 0, 10 * lda));
+    }
+
+    /// prepare the buffers of ?spev/?hpev for an n-by-n matrix in packed storage
+    void reserve_packed(const size_type n) {
+      if constexpr (is_complex_v<T>) {
+        grow(work_, std::max<std::size_t>(2 * n, 2) - 1);
+        grow(rwork_, std::max<std::size_t>(3 * n, 3) - 2);
+      } else {
+        grow(work_, std::max<std::size_t>(3 * n, 1));
+      }
+    }
+
+    /// prepare the buffers of the driver of `algo` for an n-by-n matrix
+    void reserve(const size_type n, const algorithm algo) {
+      switch (resolve_algorithm(algo, n)) {
+      case algorithm::divide_and_conquer: reserve_dc(n); break;
+      case algorithm::mrrr: reserve_mrrr(n); break;
+      default: reserve(n); break;
+      }
+    }
+  }; // struct eigen_workspace
+
+  /// index range [il, iu] (0-based, inclusive) of the eigenvalues in ascending order
+  struct index_range {
+    std::size_t il, iu;
+  };
+
+  /// half-open interval (vl, vu] of the eigenvalues
+  struct value_range {
+    double vl, vu;
+  };
+
+  /// @cond
+  namespace detail {
+    // all eigenvalues (used by `algorithm::mrrr`)
+    struct full_range {};
+
+    template <class R>
+    struct is_eigen_range
+      : std::disjunction<std::is_same<R, index_range>, std::is_same<R, value_range>, std::is_same<R, full_range>> {};
+
+    template <class R>
+    inline constexpr bool is_eigen_range_v = is_eigen_range<remove_cvref_t<R>>::value;
+
+    // arguments `range, vl, vu, il, iu` of ?syevr/?heevr
+    inline auto lapack_range(const index_range& r) {
+      return std::tuple{'I', 0.0, 0.0, r.il + 1, r.iu + 1};
+    }
+
+    inline auto lapack_range(const value_range& r) {
+      return std::tuple{'V', r.vl, r.vu, std::size_t(1), std::size_t(1)};
+    }
+
+    inline auto lapack_range(const full_range&) {
+      return std::tuple{'A', 0.0, 0.0, std::size_t(1), std::size_t(1)};
+    }
+
+    // maximum number of eigenpairs to be found
+    inline std::size_t max_found(const index_range& r, const std::size_t) {
+      return r.iu - r.il + 1;
+    }
+
+    inline std::size_t max_found(const value_range&, const std::size_t n) {
+      return n;
+    }
+
+    inline std::size_t max_found(const full_range&, const std::size_t n) {
+      return n;
+    }
+  } // namespace detail
+  /// @endcond
+
+  /// solve Ax = λx with a symmetric matrix A
+  template <class InOutMat, class OutVec, class Work>
+  std::enable_if_t<std::conjunction_v<
+    is_sized_range<InOutMat>, is_sized_range<OutVec>, is_sized_range<Work>>, int>
+  eigen_solve(InOutMat& A, OutVec& w, Work& work) {
+    using std::size, std::data; // for ADL
+    const std::size_t n = kspc::dim(A);
+    // std::cout << n << std::endl;
+    assert(size(A) == n * n);
+    assert(size(w) == n);
+    assert(size(work) >= 3 * n - 1);
+
+    const std::size_t lda = kspc::detail::lapack_lda(A, n);
+    int info;
+    //      syev(jobz, uplo, n,      A , lda,      w ,      work ,     lwork , info)
+    detail::syev( 'V',  'U', n, data(A), lda, data(w), data(work), size(work), info);
+    return info;
+  }
+
+  /// @brief solve Ax = λx with a hermitian matrix A
+  /// @example haldane.cpp
+  template <class InOutMat, class OutVec, class Work, class RWork>
+  std::enable_if_t<std::conjunction_v<
+    is_sized_range<InOutMat>, is_sized_range<OutVec>, is_sized_range<Work>, is_sized_range<RWork>>, int>
+  eigen_solve(InOutMat& A, OutVec& w, Work& work, RWork& rwork) {
+    using std::size, std::data; // for ADL
+    const std::size_t n = kspc::dim(A);
+    // std::cout << n << std::endl;
+    assert(size(A) == n * n);
+    assert(size(w) == n);
+    assert(size(work) >= 2 * n - 1);
+    assert(size(rwork) >= 3 * n - 2);
+
+    const std::size_t lda = kspc::detail::lapack_lda(A, n);
+    int info;
+    //      heev(jobz, uplo, n,      A , lda,      w ,      work ,     lwork ,      rwork , info)
+    detail::heev( 'V',  'U', n, data(A), lda, data(w), data(work), size(work), data(rwork), info);
+    return info;
+  }
+
+  /// @brief solve Ax = λx with a hermitian (symmetric) matrix A using a reusable workspace
+  /// @details `algo` selects the LAPACK driver.
+  template <class InOutMat, class OutVec, class T>
+  std::enable_if_t<std::conjunction_v<is_sized_range<InOutMat>, is_sized_range<OutVec>>, int>
+  eigen_solve(InOutMat& A, OutVec& w, eigen_workspace<T>& ws, const algorithm algo = algorithm::automatic) {
+    using std::size, std::data, std::begin; // for ADL
+    const std::size_t n = kspc::dim(A);
+    assert(size(A) == n * n);
+    assert(size(w) == n);
+
+    switch (resolve_algorithm(algo, n)) {
+    case algorithm::divide_and_conquer: {
+      ws.reserve_dc(n);
+      const std::size_t lda = kspc::detail::lapack_lda(A, n);
+      auto& work = ws.work();
+      auto& iwork = ws.iwork();
+      int info;
+      if constexpr (is_complex_v<T>) {
+        auto& rwork = ws.rwork();
+        //      heevd(jobz, uplo, n,      A , lda,      w ,      work ,     lwork ,      rwork ,     lrwork ,      iwork ,     liwork , info)
+        detail::heevd( 'V',  'U', n, data(A), lda, data(w), data(work), size(work), data(rwork), size(rwork), data(iwork), size(iwork), info);
+      } else {
+        //      syevd(jobz, uplo, n,      A , lda,      w ,      work ,     lwork ,      iwork ,     liwork , info)
+        detail::syevd( 'V',  'U', n, data(A), lda, data(w), data(work), size(work), data(iwork), size(iwork), info);
+      }
+      return info;
+    }
+    case algorithm::mrrr: {
+      ws.reserve_mrrr(n);
+      auto& Z = ws.eigenvectors();
+      std::size_t m;
+      const int info = eigen_solve(A, detail::full_range{}, m, w, Z, ws);
+      const std::size_t lda = kspc::detail::lapack_lda(A, n);
+      for (std::size_t k = 0; k < n; ++k) {
+        std::copy_n(Z.begin() + static_cast<std::ptrdiff_t>(k * n), n, data(A) + k * lda);
+      }
+      return info;
+    }
+    default:
+      ws.reserve(n);
+      if constexpr (is_complex_v<T>) {
+        return eigen_solve(A, w, ws.work(), ws.rwork());
+      } else {
+        return eigen_solve(A, w, ws.work());
+      }
+    }
+  }
+
+  /// @overload
+  template <class InOutMat, class OutVec, class T, class M, class P = identity_fn>
+  std::enable_if_t<
+    is_sized_range_v<InOutMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+  eigen_solve(InOutMat& A, OutVec& w, eigen_workspace<T>& ws, const algorithm algo, M&& map, P&& proj = {}) {
+    using std::data; // for ADL
+    const std::size_t n = kspc::dim(A);
+    if constexpr (kspc::detail::is_dense_layout_v<InOutMat, T, M, P>) {
+      if (map.lda() >= n) {
+        // A dense column-major A is solved in place with its leading dimension. A dense row-major
+        // A read as column-major is A^T = conj(A), whose eigenvectors conj(V) are turned into the
+        // row-major V by a conjugate transposition in place.
+        matrix_view<T, dynamic_extent, mapping::column_major> a(data(A), n, mapping::column_major(map.lda()));
+        const int info = eigen_solve(a, w, ws, algo);
+        if constexpr (is_same_uncvref_v<M, mapping::row_major>)
+          kspc::detail::conj_transpose_in_place(a, n, map.lda());
+        return info;
+      }
+    }
+
+    ws.reserve(n, algo);
+    auto& B = ws.matrix();
+    const auto column_major = mapping::column_major(n);
+    matrix_copy(A, B, map, column_major, proj);
+    const int info = eigen_solve(B, w, ws, algo);
+    matrix_copy(B, A, column_major, map);
+    return info;
+  }
+
+  /// @overload
+  template <class InOutMat, class OutVec, class T, class M, class P = identity_fn>
+  std::enable_if_t<
+    is_sized_range_v<InOutMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+  eigen_solve(InOutMat& A, OutVec& w, eigen_workspace<T>& ws, M&& map, P&& proj = {}) {
+    return eigen_solve(A, w, ws, algorithm::automatic, map, proj);
+  }
+
+  /// @overload
+  template <class InOutMat, class OutVec, class M, class P = identity_fn>
+  std::enable_if_t<
+    is_sized_range_v<InOutMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+  eigen_solve(InOutMat& A, OutVec& w, const algorithm algo, M&& map, P&& proj = {}) {
+    using T = remove_cvref_t<std::invoke_result_t<P&, range_reference_t<InOutMat>>>;
+
+    if constexpr (is_fixed_size_array_v<remove_cvref_t<InOutMat>>) {
+      static eigen_workspace<T> ws;
+      return eigen_solve(A, w, ws, algo, map, proj);
+    } else {
+      eigen_workspace<T> ws;
+      return eigen_solve(A, w, ws, algo, map, proj);
+    }
+  }
+
+  /// @overload
+  template <class InOutMat, class OutVec, class M, class P = identity_fn>
+  std::enable_if_t<
+    is_sized_range_v<InOutMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+  eigen_solve(InOutMat& A, OutVec& w, M&& map, P&& proj = {}) {
+    return eigen_solve(A, w, algorithm::automatic, map, proj);
+  }
+
+  /// @brief solve Ax = λx for the eigenvalues in `range` with a hermitian (symmetric) matrix A
+  /// @details The number of eigenvalues found is stored in `m`. The first `m` elements of `w` and
+  /// the first `m` columns of the column-major `Z` hold the selected eigenpairs.
+  template <class InOutMat, class Range, class OutVec, class OutMat, class T>
+  std::enable_if_t<detail::is_eigen_range_v<Range> and std::conjunction_v<
+    is_sized_range<InOutMat>, is_sized_range<OutVec>, is_sized_range<OutMat>>, int>
+  eigen_solve(InOutMat& A, const Range& range, std::size_t& m, OutVec& w, OutMat& Z, eigen_workspace<T>& ws) {
+    using std::size, std::data; // for ADL
+    const std::size_t n = kspc::dim(A);
+    assert(size(A) == n * n);
+    assert(size(w) == n);
+    assert(size(Z) >= n * detail::max_found(range, n));
+
+    ws.reserve_mrrr(n);
+    const auto [r, vl, vu, il, iu] = detail::lapack_range(range);
+    const std::size_t lda = kspc::detail::lapack_lda(A, n);
+    const std::size_t ldz = std::max<std::size_t>(n, 1);
+    auto& work = ws.work();
+    auto& iwork = ws.iwork();
+    int found = 0, info;
+    if constexpr (is_complex_v<T>) {
+      auto& rwork = ws.rwork();
+      //      heevr(jobz, range, uplo, n,      A , lda, vl, vu, il, iu, abstol,     m ,      w ,      Z , ldz,      isuppz     ,      work ,     lwork ,      rwork ,     lrwork ,      iwork ,     liwork , info)
+      detail::heevr( 'V',     r,  'U', n, data(A), lda, vl, vu, il, iu,    0.0, found, data(w), data(Z), ldz, ws.isuppz().data(), data(work), size(work), data(rwork), size(rwork), data(iwork), size(iwork), info);
+    } else {
+      //      syevr(jobz, range, uplo, n,      A , lda, vl, vu, il, iu, abstol,     m ,      w ,      Z , ldz,      isuppz     ,      work ,     lwork ,      iwork ,     liwork , info)
+      detail::syevr( 'V',     r,  'U', n, data(A), lda, vl, vu, il, iu,    0.0, found, data(w), data(Z), ldz, ws.isuppz().data(), data(work), size(work), data(iwork), size(iwork), info);
+    }
+    m = static_cast<std::size_t>(found);
+    return info;
+  }
+
+  /// @brief solve Ax = λx for the eigenvalues in `range` with a hermitian (symmetric) matrix A
+  /// @details The first `m` columns of A are overwritten with the selected eigenvectors. The
+  /// other elements of A are unspecified after the call: a dense A is handed over to LAPACK
+  /// in place, which destroys its upper triangle, while other layouts are solved on a copy.
+  template <class InOutMat, class Range, class OutVec, class T, class M, class P = identity_fn>
+  std::enable_if_t<
+    detail::is_eigen_range_v<Range> and is_sized_range_v<InOutMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+  eigen_solve(InOutMat& A, const Range& range, std::size_t& m, OutVec& w, eigen_workspace<T>& ws, M&& map, P&& proj = {}) {
+    const std::size_t n = kspc::dim(A);
+    ws.reserve_mrrr(n);
+    auto& Z = ws.eigenvectors();
+    int info;
+    bool solved = false, conjugated = false;
+    if constexpr (kspc::detail::is_dense_layout_v<InOutMat, T, M, P>) {
+      if (map.lda() >= n) {
+        // A dense row-major A read as column-major is conj(A), whose eigenvectors are conj(V).
+        matrix_view<T, dynamic_extent, mapping::column_major> a(adl_data(A), n, mapping::column_major(map.lda()));
+        info = eigen_solve(a, range, m, w, Z, ws);
+        solved = true;
+        conjugated = is_same_uncvref_v<M, mapping::row_major>;
+      }
+    }
+    if (not solved) {
+      auto& B = ws.matrix();
+      matrix_copy(A, B, map, mapping::column_major(n), proj);
+      info = eigen_solve(B, range, m, w, Z, ws);
+    }
+
+    for (std::size_t k = 0; k < m; ++k) {
+      for (std::size_t j = 0; j < n; ++j) {
+        A[map(j, k)] = conjugated ? kspc::conj(Z[j + k * n]) : Z[j + k * n];
+      }
+    }
+    return info;
+  }
+
+  /// @overload
+  template <class InOutMat, class Range, class OutVec, class M, class P = identity_fn>
+  std::enable_if_t<
+    detail::is_eigen_range_v<Range> and is_sized_range_v<InOutMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+  eigen_solve(InOutMat& A, const Range& range, std::size_t& m, OutVec& w, M&& map, P&& proj = {}) {
+    using T = remove_cvref_t<std::invoke_result_t<P&, range_reference_t<InOutMat>>>;
+
+    if constexpr (is_fixed_size_array_v<remove_cvref_t<InOutMat>>) {
+      static eigen_workspace<T> ws;
+      return eigen_solve(A, range, m, w, ws, map, proj);
+    } else {
+      eigen_workspace<T> ws;
+      return eigen_solve(A, range, m, w, ws, map, proj);
+    }
+  }
+
+  /// @brief solve Ax = λx with a hermitian (symmetric) matrix view A in its own layout
+  template <class T, std::size_t E, class L, class OutVec>
+  std::enable_if_t<is_sized_range_v<OutVec>, int>
+  eigen_solve(matrix_view<T, E, L> A, OutVec& w, const algorithm algo = algorithm::automatic) {
+    return eigen_solve(A, w, algo, A.mapping());
+  }
+
+  /// @}
+} // namespace kspc
+
+// hermitian matrix eigen solve without eigenvectors
+namespace kspc::hermitian::no_evec {
+  /// @addtogroup linalg
+  /// @{
+
+  /// solve Ax = λx with a symmetric matrix A without eigenvectors
+  template <class InOutMat, class OutVec, class Work>
+  std::enable_if_t<std::conjunction_v<
+    is_sized_range<InOutMat>, is_sized_range<OutVec>, is_sized_range<Work>>, int>
+  eigen_solve(InOutMat& A, OutVec& w, Work& work) {
+    using std::size, std::data; // for ADL
+    const std::size_t n = kspc::dim(A);
+    // std::cout << n << std::endl;
+    assert(size(A) == n * n);
+    assert(size(w) == n);
+    assert(size(work) >= 3 * n - 1);
+
+    const std::size_t lda = kspc::detail::lapack_lda(A, n);
+    int info;
+    //      syev(jobz, uplo, n,      A , lda,      w ,      work ,     lwork , info)
+    detail::syev( 'N',  'U', n, data(A), lda, data(w), data(work), size(work), info);
+    return info;
+  }
+
+  /// solve Ax = λx with a hermitian matrix A without eigenvectors
+  template <class InOutMat, class OutVec, class Work, class RWork>
+  std::enable_if_t<std::conjunction_v<
+    is_sized_range<InOutMat>, is_sized_range<OutVec>, is_sized_range<Work>, is_sized_range<RWork>>, int>
+  eigen_solve(InOutMat& A, OutVec& w, Work& work, RWork& rwork) {
+    using std::size, std::data; // for ADL
+    const std::size_t n = kspc::dim(A);
+    // std::cout << n << std::endl;
+    assert(size(A) == n * n);
+    assert(size(w) == n);
+    assert(size(work) >= 2 * n - 1);
+    assert(size(rwork) >= 3 * n - 2);
+
+    const std::size_t lda = kspc::detail::lapack_lda(A, n);
+    int info;
+    //      heev(jobz, uplo, n,      A , lda,      w ,      work ,     lwork ,      rwork , info)
+    detail::heev( 'N',  'U', n, data(A), lda, data(w), data(work), size(work), data(rwork), info);
+    return info;
+  }
+
+  /// solve Ax = λx with a hermitian (symmetric) matrix A using a reusable workspace without eigenvectors
+  template <class InOutMat, class OutVec, class T>
+  std::enable_if_t<std::conjunction_v<is_sized_range<InOutMat>, is_sized_range<OutVec>>, int>
+  eigen_solve(InOutMat& A, OutVec& w, eigen_workspace<T>& ws) {
+    ws.reserve(kspc::dim(A));
+    // NOTE: qualified to suppress ADL of `kspc::hermitian::eigen_solve`
+    if constexpr (is_complex_v<T>) {
+      return no_evec::eigen_solve(A, w, ws.work(), ws.rwork());
+    } else {
+      return no_evec::eigen_solve(A, w, ws.work());
+    }
+  }
+
+  /// @overload
+  template <class InMat, class OutVec, class T, class M, class P = identity_fn>
+  std::enable_if_t<
+    is_sized_range_v<InMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+  eigen_solve(InMat& A, OutVec& w, eigen_workspace<T>& ws, M&& map, P&& proj = {}) {
+    using std::begin, std::end; // for ADL
+    const std::size_t n = kspc::dim(A);
+    ws.reserve(n);
+    auto& B = ws.matrix();
+    // The eigenvalues of A^T = conj(A) are those of A, so a dense layout needs no transposition.
+    if constexpr (kspc::detail::is_dense_layout_v<InMat, T, M, P>) {
+      if (map.lda() == n) {
+        std::copy(begin(A), end(A), begin(B));
+        return no_evec::eigen_solve(B, w, ws);
+      }
+    }
+    const auto column_major = mapping::column_major(n);
+    matrix_copy(A, B, map, column_major, proj);
+    return no_evec::eigen_solve(B, w, ws);
+  }
+
+  /// @overload
+  template <class InOutMat, class OutVec, class M, class P = identity_fn>
+  std::enable_if_t<
+    is_sized_range_v<InOutMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
   eigen_solve(InOutMat& A, OutVec& w, M&& map, P&& proj = {}) {
     using T = remove_cvref_t<std::invoke_result_t<P&, range_reference_t<InOutMat>>>;
-    int info;
 
     if constexpr (is_fixed_size_array_v<remove_cvref_t<InOutMat>>) {
       constexpr std::size_t N = fixed_size_matrix_dim_v<remove_cvref_t<InOutMat>>;
-      static std::array<T, N * N> B;
-      constexpr auto column_major = mapping::column_major(N);
-      matrix_copy(A, B, map, column_major, proj);
+      static eigen_workspace<T> ws(N);
+      return no_evec::eigen_solve(A, w, ws, map, proj);
+    } else {
+      eigen_workspace<T> ws(kspc::dim(A));
+      return no_evec::eigen_solve(A, w, ws, map, proj);
+    }
+  }
 
-      if constexpr (is_complex_v<T>) {
-        static std::array<T, 4 * N> work;
-        static std::array<typename T::value_type, N == 0 ? 0 : 3 * N - 2> rwork;
-        info = eigen_solve(B, w, work, rwork);
-      } else {
-        static std::array<T, 6 * N> work;
-        info = eigen_solve(B, w, work);
+  /// solve Ax = λx for the eigenvalues in `range` with a hermitian (symmetric) matrix A without eigenvectors
+  template <class InOutMat, class Range, class OutVec, class T>
+  std::enable_if_t<detail::is_eigen_range_v<Range> and std::conjunction_v<
+    is_sized_range<InOutMat>, is_sized_range<OutVec>>, int>
+  eigen_solve(InOutMat& A, const Range& range, std::size_t& m, OutVec& w, eigen_workspace<T>& ws) {
+    using std::size, std::data; // for ADL
+    const std::size_t n = kspc::dim(A);
+    assert(size(A) == n * n);
+    assert(size(w) == n);
+
+    ws.reserve_mrrr(n);
+    const auto [r, vl, vu, il, iu] = detail::lapack_range(range);
+    const std::size_t lda = kspc::detail::lapack_lda(A, n);
+    auto& work = ws.work();
+    auto& iwork = ws.iwork();
+    int found = 0, info;
+    if constexpr (is_complex_v<T>) {
+      auto& rwork = ws.rwork();
+      //      heevr(jobz, range, uplo, n,      A , lda, vl, vu, il, iu, abstol,     m ,      w ,             Z            , ldz,      isuppz     ,      work ,     lwork ,      rwork ,     lrwork ,      iwork ,     liwork , info)
+      detail::heevr( 'N',     r,  'U', n, data(A), lda, vl, vu, il, iu,    0.0, found, data(w), ws.eigenvectors().data(),   1, ws.isuppz().data(), data(work), size(work), data(rwork), size(rwork), data(iwork), size(iwork), info);
+    } else {
+      //      syevr(jobz, range, uplo, n,      A , lda, vl, vu, il, iu, abstol,     m ,      w ,             Z            , ldz,      isuppz     ,      work ,     lwork ,      iwork ,     liwork , info)
+      detail::syevr( 'N',     r,  'U', n, data(A), lda, vl, vu, il, iu,    0.0, found, data(w), ws.eigenvectors().data(),   1, ws.isuppz().data(), data(work), size(work), data(iwork), size(iwork), info);
+    }
+    m = static_cast<std::size_t>(found);
+    return info;
+  }
+
+  /// @overload
+  template <class InMat, class Range, class OutVec, class T, class M, class P = identity_fn>
+  std::enable_if_t<
+    detail::is_eigen_range_v<Range> and is_sized_range_v<InMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+  eigen_solve(InMat& A, const Range& range, std::size_t& m, OutVec& w, eigen_workspace<T>& ws, M&& map, P&& proj = {}) {
+    using std::begin, std::end; // for ADL
+    const std::size_t n = kspc::dim(A);
+    ws.reserve_mrrr(n);
+    auto& B = ws.matrix();
+    if constexpr (kspc::detail::is_dense_layout_v<InMat, T, M, P>) {
+      if (map.lda() == n) {
+        std::copy(begin(A), end(A), begin(B));
+        return no_evec::eigen_solve(B, range, m, w, ws);
       }
+    }
+    matrix_copy(A, B, map, mapping::column_major(n), proj);
+    return no_evec::eigen_solve(B, range, m, w, ws);
+  }
+
+  /// @overload
+  template <class InOutMat, class Range, class OutVec, class M, class P = identity_fn>
+  std::enable_if_t<
+    detail::is_eigen_range_v<Range> and is_sized_range_v<InOutMat> and is_sized_range_v<OutVec> and (not is_sized_range_v<M>) and (not is_sized_range_v<P>), int>
+  eigen_solve(InOutMat& A, const Range& range, std::size_t& m, OutVec& w, M&& map, P&& proj = {}) {
+    using T = remove_cvref_t<std::invoke_result_t<P&, range_reference_t<InOutMat>>>;
+
+    if constexpr (is_fixed_size_array_v<remove_cvref_t<InOutMat>>) {
+      static eigen_workspace<T> ws;
+      return no_evec::eigen_solve(A, range, m, w, ws, map, proj);
     } else {
-      const std::size_t n = kspc::dim(A);
-      std::vector<T> B(n * n);
-      const auto column_major = mapping::column_major(n);
-      matrix_copy(A, B, map, column_major, proj);
+      eigen_workspace<T> ws;
+      return no_evec::eigen_solve(A, range, m, w, ws, map, proj);
+    }
+  }
 
-      if constexpr (is_complex_v<T>) {
-        std::vector<T> work(4 * n);
-        std::vector<typename T::value_type> rwork(n == 0 ? 0 : 3 * n - 2);
-        info = eigen_solve(B, w, work, rwork);
-      } else {
-        std::vector<T> work(6 * n);
-        info = eigen_solve(B, w, work);
+  /// @brief solve Ax = λx with a hermitian (symmetric) matrix view A in its own layout without eigenvectors
+  template <class T, std::size_t E, class L, class OutVec>
+  std::enable_if_t<is_sized_range_v<OutVec>, int>
+  eigen_solve(matrix_view<T, E, L> A, OutVec& w) {
+    return no_evec::eigen_solve(A, w, A.mapping());
+  }
+
+  /// @}
+} // namespace kspc
+
+// hermitian matrix in packed storage
+namespace kspc::hermitian {
+  /// @addtogroup linalg
+  /// @{
+
+  /// @brief pack the upper triangle of a hermitian (symmetric) matrix A into AP
+  /// @details AP has `mapping::packed_upper::packed_size(n)` elements.
+  template <class InMat, class OutVec, class M, class P = identity_fn>
+  void pack(const InMat& A, OutVec& AP, M&& map, P&& proj = {}) {
+    using std::size; // for ADL
+    const std::size_t n = kspc::dim(A);
+    assert(size(AP) == mapping::packed_upper::packed_size(n));
+    constexpr auto packed = mapping::packed_upper();
+
+    for (std::size_t j = 0; j < n; ++j) {
+      for (std::size_t i = 0; i <= j; ++i) {
+        AP[packed(i, j)] = std::invoke(proj, A[map(i, j)]);
+      }
+    }
+  }
+
+  /// @brief unpack AP into the full hermitian (symmetric) matrix A
+  template <class InVec, class OutMat, class M>
+  void unpack(const InVec& AP, OutMat& A, M&& map) {
+    using std::size; // for ADL
+    const std::size_t n = mapping::packed_upper::dim(size(AP));
+    assert(size(AP) == mapping::packed_upper::packed_size(n));
+    constexpr auto packed = mapping::packed_upper();
+
+    for (std::size_t j = 0; j < n; ++j) {
+      for (std::size_t i = 0; i < j; ++i) {
+        A[map(i, j)] = AP[packed(i, j)];
+        A[map(j, i)] = kspc::conj(AP[packed(i, j)]);
       }
+      A[map(j, j)] = AP[packed(j, j)];
+    }
+  }
+
+  /// @brief solve Ax = λx with a hermitian (symmetric) matrix A in packed storage
+  /// @details AP is overwritten. The eigenvectors are stored in the columns of the column-major
+  /// n-by-n matrix Z.
+  template <class InOutVec, class OutVec, class OutMat, class T>
+  std::enable_if_t<std::conjunction_v<is_sized_range<InOutVec>, is_sized_range<OutVec>, is_sized_range<OutMat>>, int>
+  eigen_solve(InOutVec& AP, OutVec& w, OutMat& Z, eigen_workspace<T>& ws, mapping::packed_upper) {
+    using std::size, std::data; // for ADL
+    const std::size_t n = mapping::packed_upper::dim(size(AP));
+    assert(size(AP) == mapping::packed_upper::packed_size(n));
+    assert(size(w) == n);
+    assert(size(Z) == n * n);
+
+    ws.reserve_packed(n);
+    const std::size_t ldz = std::max<std::size_t>(n, 1);
+    int info;
+    if constexpr (is_complex_v<T>) {
+      //      hpev(jobz, uplo, n,      AP ,      w ,      Z , ldz,      work         ,      rwork         , info)
+      detail::hpev( 'V',  'U', n, data(AP), data(w), data(Z), ldz, ws.work().data(), ws.rwork().data(), info);
+    } else {
+      //      spev(jobz, uplo, n,      AP ,      w ,      Z , ldz,      work         , info)
+      detail::spev( 'V',  'U', n, data(AP), data(w), data(Z), ldz, ws.work().data(), info);
     }
+    return info;
+  }
+
+  /// @overload
+  template <class InOutVec, class OutVec, class OutMat>
+  std::enable_if_t<std::conjunction_v<is_sized_range<InOutVec>, is_sized_range<OutVec>, is_sized_range<OutMat>>, int>
+  eigen_solve(InOutVec& AP, OutVec& w, OutMat& Z, mapping::packed_upper packed) {
+    eigen_workspace<range_value_t<InOutVec>> ws;
+    return eigen_solve(AP, w, Z, ws, packed);
+  }
+
+  /// @}
+} // namespace kspc::hermitian
 
+// hermitian matrix in packed storage without eigenvectors
+namespace kspc::hermitian::no_evec {
+  /// @addtogroup linalg
+  /// @{
+
+  /// @brief solve Ax = λx with a hermitian (symmetric) matrix A in packed storage without eigenvectors
+  /// @details AP is overwritten.
+  template <class InOutVec, class OutVec, class T>
+  std::enable_if_t<std::conjunction_v<is_sized_range<InOutVec>, is_sized_range<OutVec>>, int>
+  eigen_solve(InOutVec& AP, OutVec& w, eigen_workspace<T>& ws, mapping::packed_upper) {
+    using std::size, std::data; // for ADL
+    const std::size_t n = mapping::packed_upper::dim(size(AP));
+    assert(size(AP) == mapping::packed_upper::packed_size(n));
+    assert(size(w) == n);
+
+    ws.reserve_packed(n);
+    T z{}; // not referenced
+    int info;
+    if constexpr (is_complex_v<T>) {
+      //      hpev(jobz, uplo, n,      AP ,      w ,  Z, ldz,      work         ,      rwork         , info)
+      detail::hpev( 'N',  'U', n, data(AP), data(w), &z,   1, ws.work().data(), ws.rwork().data(), info);
+    } else {
+      //      spev(jobz, uplo, n,      AP ,      w ,  Z, ldz,      work         , info)
+      detail::spev( 'N',  'U', n, data(AP), data(w), &z,   1, ws.work().data(), info);
+    }
     return info;
   }
 
+  /// @overload
+  template <class InOutVec, class OutVec>
+  std::enable_if_t<std::conjunction_v<is_sized_range<InOutVec>, is_sized_range<OutVec>>, int>
+  eigen_solve(InOutVec& AP, OutVec& w, mapping::packed_upper packed) {
+    eigen_workspace<range_value_t<InOutVec>> ws;
+    return no_evec::eigen_solve(AP, w, ws, packed);
+  }
+
+  /// @}
+} // namespace kspc::hermitian::no_evec
+
+// hermitian iterative eigen solve
+namespace kspc::hermitian {
+  /// @addtogroup linalg
+  /// @{
+
+  /// @brief block Davidson solver for the lowest eigenpairs of a large hermitian operator
+  /// @details The operator is given matrix-free as `op(x, y)`, which computes y = A x for
+  /// pointers `x` and `y` to n elements. The projected problem is solved by `eigen_solve`. If the
+  /// diagonal of A is given, it is used as the (Jacobi) preconditioner and for the initial
+  /// vectors; otherwise the residuals themselves expand the subspace. The buffers are kept
+  /// between calls, so that a sweep over k-points does not reallocate, and the eigenvectors of
+  /// the previous k-point can be passed as the initial subspace (`warm_start`).
+  template <class T>
+  struct davidson {
+  private:
+    using real_type = detail::real_value_t<T>;
+    real_type tol_ = std::sqrt(std::numeric_limits<real_type>::epsilon());
+    std::size_t max_iter_ = 1000;
+    std::size_t max_subspace_ = 0;
+    std::size_t iter_ = 0;
+    std::vector<T> v_{};  // orthonormal basis V (n-by-m, column-major)
+    std::vector<T> av_{}; // A V
+    std::vector<T> h_{};  // V^† A V
+    std::vector<T> x_{};  // Ritz vectors
+    std::vector<T> ax_{}; // A X
+    std::vector<T> t_{};  // correction vector
+    std::vector<real_type> theta_{};
+    std::vector<real_type> rnorm_{};
+    std::vector<std::size_t> seed_{};
+    eigen_workspace<T> ws_{};
+
+    static T dot(const T* a, const T* b, const std::size_t n) {
+      T x = 0;
+      for (std::size_t i = 0; i < n; ++i) x += conj_fn{}(a[i]) * b[i];
+      return x;
+    }
+
+    // orthonormalize t_ against the m columns of V and append it to V; false if t_ is (nearly)
+    // in the span of V
+    template <class Op>
+    bool append(Op& op, const std::size_t n, std::size_t& m) {
+      const real_type norm0 = std::sqrt(std::real(dot(t_.data(), t_.data(), n)));
+      if (norm0 == 0) return false;
+      for (int pass = 0; pass < 2; ++pass) {
+        for (std::size_t j = 0; j < m; ++j) {
+          const T c = dot(v_.data() + j * n, t_.data(), n);
+          for (std::size_t i = 0; i < n; ++i) t_[i] -= c * v_[i + j * n];
+        }
+      }
+      const real_type norm = std::sqrt(std::real(dot(t_.data(), t_.data(), n)));
+      if (norm <= 100 * std::numeric_limits<real_type>::epsilon() * norm0) return false;
+      for (std::size_t i = 0; i < n; ++i) v_[i + m * n] = t_[i] / norm;
+      op(static_cast<const T*>(v_.data() + m * n), av_.data() + m * n);
+      ++m;
+      return true;
+    }
+
+    template <class Op>
+    int solve_impl(Op& op, const real_type* diag, const std::size_t n, const std::size_t il,
+                   const std::size_t k, T* X, real_type* w, const bool warm_start) {
+      assert(0 < k and k <= n);
+      const std::size_t mmax = std::min(n, std::max(max_subspace_ == 0 ? 4 * k : max_subspace_, 2 * k));
+      v_.resize(n * mmax);
+      av_.resize(n * mmax);
+      x_.resize(n * k);
+      ax_.resize(n * k);
+      t_.resize(n);
+      rnorm_.resize(k);
+
+      // initial subspace: the given vectors, then unit vectors at the smallest diagonal
+      // elements or pseudo-random vectors
+      std::size_t m = 0;
+      if (warm_start) {
+        for (std::size_t i = 0; i < k; ++i) {
+          std::copy_n(X + i * n, n, t_.begin());
+          append(op, n, m);
+        }
+      }
+      if (diag) {
+        seed_.resize(n);
+        for (std::size_t i = 0; i < n; ++i) seed_[i] = i;
+        std::stable_sort(seed_.begin(), seed_.end(), [diag](auto a, auto b) { return diag[a] < diag[b]; });
+      }
+      std::mt19937 gen(0);
+      std::uniform_real_distribution<real_type> dist(-0.5, 0.5);
+      for (std::size_t s = 0; m < k; ++s) {
+        if (diag and s < n) {
+          std::fill(t_.begin(), t_.end(), T(0));
+          t_[seed_[s]] = 1;
+        } else {
+          for (auto& x : t_) {
+            if constexpr (is_complex_v<T>) {
+              x = T(dist(gen), dist(gen));
+            } else {
+              x = dist(gen);
+            }
+          }
+        }
+        append(op, n, m);
+      }
+
+      int unconverged = 0;
+      for (iter_ = 0; iter_ < max_iter_; ++iter_) {
+        // Rayleigh-Ritz: V^† A V S = S Θ
+        h_.resize(m * m);
+        theta_.resize(m);
+        for (std::size_t j = 0; j < m; ++j) {
+          for (std::size_t i = 0; i <= j; ++i) {
+            h_[i + j * m] = dot(v_.data() + i * n, av_.data() + j * n, n);
+          }
+        }
+        const int info = eigen_solve(h_, theta_, ws_, algorithm::qr);
+        if (info != 0) return info < 0 ? info : -info;
+
+        // Ritz vectors X = V S and A X = A V S, and the residuals A X - θ X
+        std::fill(x_.begin(), x_.end(), T(0));
+        std::fill(ax_.begin(), ax_.end(), T(0));
+        for (std::size_t i = 0; i < k; ++i) {
+          for (std::size_t j = 0; j < m; ++j) {
+            const T s = h_[j + i * m];
+            for (std::size_t l = 0; l < n; ++l) {
+              x_[l + i * n] += v_[l + j * n] * s;
+              ax_[l + i * n] += av_[l + j * n] * s;
+            }
+          }
+        }
+        unconverged = 0;
+        for (std::size_t i = 0; i < k; ++i) {
+          real_type r2 = 0;
+          for (std::size_t l = 0; l < n; ++l) r2 += std::norm(ax_[l + i * n] - theta_[i] * x_[l + i * n]);
+          rnorm_[i] = std::sqrt(r2);
+          if (i >= il and rnorm_[i] > tol_ * std::max<real_type>(1, std::abs(theta_[i]))) ++unconverged;
+        }
+        if (unconverged == 0) break;
+
+        // restart with the Ritz vectors if there is no room for the corrections
+        std::size_t expanding = 0;
+        for (std::size_t i = 0; i < k; ++i) {
+          if (rnorm_[i] > tol_ * std::max<real_type>(1, std::abs(theta_[i]))) ++expanding;
+        }
+        if (m + expanding > mmax) {
+          std::copy(x_.begin(), x_.end(), v_.begin());
+          std::copy(ax_.begin(), ax_.end(), av_.begin());
+          m = k;
+        }
+
+        // expand V by the (preconditioned) residuals
+        std::size_t added = 0;
+        for (std::size_t i = 0; i < k and m < mmax; ++i) {
+          if (rnorm_[i] <= tol_ * std::max<real_type>(1, std::abs(theta_[i]))) continue;
+          for (std::size_t l = 0; l < n; ++l) {
+            t_[l] = ax_[l + i * n] - theta_[i] * x_[l + i * n];
+            if (diag) {
+              const real_type d = theta_[i] - diag[l];
+              const real_type eps = std::sqrt(std::numeric_limits<real_type>::epsilon());
+              t_[l] /= std::abs(d) < eps ? std::copysign(eps, d) : d;
+            }
+          }
+          if (append(op, n, m)) ++added;
+        }
+        if (added == 0) break;
+      }
+
+      for (std::size_t i = 0; i < k; ++i) w[i] = theta_[i];
+      std::copy(x_.begin(), x_.end(), X);
+      return unconverged;
+    }
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    davidson() = default;
+    /// @param tol convergence criterion: |A x - θ x| <= tol max(1, |θ|)
+    /// @param max_iter maximum number of iterations
+    /// @param max_subspace maximum dimension of the subspace before restart (0: 4 k)
+    explicit davidson(const real_type tol, const size_type max_iter = 1000, const size_type max_subspace = 0)
+      : tol_(tol), max_iter_(max_iter), max_subspace_(max_subspace) {}
+
+    /// number of iterations of the last `solve`
+    size_type iterations() const noexcept {
+      return iter_;
+    }
+
+    /// @brief solve A x = λ x for the k = size(w) lowest eigenpairs
+    /// @details X is the column-major n-by-k matrix of the eigenvectors (the initial subspace if
+    /// `warm_start`). Returns the number of the unconverged eigenpairs (negative on a LAPACK
+    /// error).
+    template <class Op, class OutVec, class InOutMat>
+    std::enable_if_t<std::conjunction_v<is_sized_range<OutVec>, is_sized_range<InOutMat>>, int>
+    solve(Op&& op, OutVec& w, InOutMat& X, const bool warm_start = false) {
+      using std::size, std::data; // for ADL
+      const std::size_t k = size(w);
+      return solve_impl(op, nullptr, size(X) / k, 0, k, data(X), data(w), warm_start);
+    }
+
+    /// @overload
+    /// @details Only the eigenpairs in `range` are required to converge. w and X hold all the
+    /// iu + 1 lowest eigenpairs.
+    template <class Op, class OutVec, class InOutMat>
+    std::enable_if_t<std::conjunction_v<is_sized_range<OutVec>, is_sized_range<InOutMat>>, int>
+    solve(Op&& op, const index_range& range, OutVec& w, InOutMat& X, const bool warm_start = false) {
+      using std::size, std::data; // for ADL
+      const std::size_t k = range.iu + 1;
+      assert(range.il <= range.iu and size(w) == k);
+      return solve_impl(op, nullptr, size(X) / k, range.il, k, data(X), data(w), warm_start);
+    }
+
+    /// @overload
+    /// @details `diag` is the diagonal of A used as the preconditioner.
+    template <class Op, class InVec, class OutVec, class InOutMat>
+    std::enable_if_t<std::conjunction_v<is_sized_range<InVec>, is_sized_range<OutVec>, is_sized_range<InOutMat>>, int>
+    solve(Op&& op, const InVec& diag, OutVec& w, InOutMat& X, const bool warm_start = false) {
+      using std::size, std::data; // for ADL
+      const std::size_t k = size(w);
+      assert(size(X) == size(diag) * k);
+      return solve_impl(op, data(diag), size(diag), 0, k, data(X), data(w), warm_start);
+    }
+
+    /// @overload
+    template <class Op, class InVec, class OutVec, class InOutMat>
+    std::enable_if_t<std::conjunction_v<is_sized_range<InVec>, is_sized_range<OutVec>, is_sized_range<InOutMat>>, int>
+    solve(Op&& op, const InVec& diag, const index_range& range, OutVec& w, InOutMat& X, const bool warm_start = false) {
+      using std::size, std::data; // for ADL
+      const std::size_t k = range.iu + 1;
+      assert(range.il <= range.iu and size(w) == k);
+      assert(size(X) == size(diag) * k);
+      return solve_impl(op, data(diag), size(diag), range.il, k, data(X), data(w), warm_start);
+    }
+  }; // struct davidson
+
+  /// @}
+} // namespace kspc::hermitian
+
+// sparse matrix
+namespace kspc {
+  /// @addtogroup linalg
+  /// @{
+
+  /// @brief square matrix in compressed sparse row (CSR) format
+  /// @details `A(x, y)` computes y = A x for pointers to n elements, so that the matrix is an
+  /// operator of `hermitian::davidson`. The rows are distributed over threads if every thread
+  /// gets at least `min_nnz_per_thread` nonzeros.
+  template <class T>
+  struct csr_matrix {
+  private:
+    std::size_t n_ = 0;
+    std::vector<std::size_t> row_ptr_ = {0};
+    std::vector<std::size_t> col_{};
+    std::vector<T> val_{};
+    unsigned threads_ = 0;
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    static constexpr size_type min_nnz_per_thread = size_type(1) << 15;
+
+    csr_matrix() = default;
+    /// from the CSR arrays (the columns of each row in ascending order)
+    csr_matrix(const size_type n, std::vector<size_type> row_ptr, std::vector<size_type> col, std::vector<T> val)
+      : n_(n), row_ptr_(std::move(row_ptr)), col_(std::move(col)), val_(std::move(val)) {
+      assert(row_ptr_.size() == n + 1 and col_.size() == row_ptr_.back() and val_.size() == col_.size());
+    }
+    /// from (row, column, value) triplets; the values of duplicated entries are summed
+    csr_matrix(const size_type n, std::vector<std::tuple<size_type, size_type, T>> entries)
+      : n_(n), row_ptr_(n + 1, 0) {
+      std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return std::tie(std::get<0>(a), std::get<1>(a)) < std::tie(std::get<0>(b), std::get<1>(b));
+      });
+      col_.reserve(entries.size());
+      val_.reserve(entries.size());
+      for (std::size_t e = 0; e < entries.size(); ++e) {
+        const auto& [i, j, v] = entries[e];
+        assert(i < n and j < n);
+        if (e > 0 and i == std::get<0>(entries[e - 1]) and j == std::get<1>(entries[e - 1])) {
+          val_.back() += v;
+          continue;
+        }
+        col_.push_back(j);
+        val_.push_back(v);
+        ++row_ptr_[i + 1];
+      }
+      for (std::size_t i = 0; i < n; ++i) row_ptr_[i + 1] += row_ptr_[i];
+    }
+
+    size_type dim() const noexcept {
+      return n_;
+    }
+    size_type nnz() const noexcept {
+      return col_.size();
+    }
+    const std::vector<size_type>& row_ptr() const noexcept {
+      return row_ptr_;
+    }
+    const std::vector<size_type>& column_index() const noexcept {
+      return col_;
+    }
+    std::vector<T>& values() noexcept {
+      return val_;
+    }
+    const std::vector<T>& values() const noexcept {
+      return val_;
+    }
+    /// maximum number of threads of the matrix-vector product (0: hardware concurrency)
+    void threads(const unsigned n) noexcept {
+      threads_ = n;
+    }
+
+    /// real part of the diagonal (the preconditioner of `hermitian::davidson`)
+    auto diagonal() const {
+      using std::real; // for ADL
+      std::vector<decltype(real(std::declval<T>()))> d(n_, 0);
+      for (size_type i = 0; i < n_; ++i) {
+        for (size_type p = row_ptr_[i]; p < row_ptr_[i + 1]; ++p) {
+          if (col_[p] == i) d[i] += real(val_[p]);
+        }
+      }
+      return d;
+    }
+
+    /// y = A x
+    void operator()(const T* x, T* y) const {
+      const auto kernel = [this, x, y](const size_type first, const size_type last) {
+        for (size_type i = first; i < last; ++i) {
+          T sum = 0;
+          for (size_type p = row_ptr_[i]; p < row_ptr_[i + 1]; ++p) sum += val_[p] * x[col_[p]];
+          y[i] = sum;
+        }
+      };
+      const unsigned hardware = threads_ == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : threads_;
+      const auto work = static_cast<unsigned>(std::min<size_type>(nnz() / min_nnz_per_thread, hardware));
+      parallel_for(n_, kernel, std::max(work, 1u));
+    }
+
+    /// @overload
+    template <class InVec, class OutVec>
+    std::enable_if_t<std::conjunction_v<is_sized_range<InVec>, is_sized_range<OutVec>>>
+    operator()(const InVec& x, OutVec& y) const {
+      using std::size, std::data; // for ADL
+      assert(size(x) == n_ and size(y) == n_);
+      (*this)(data(x), data(y));
+    }
+  }; // struct csr_matrix
+
+  /// copy a CSR matrix A into the dense matrix B (the `matrix_vector_solve` and `eigen_solve` paths)
+  template <class T, class OutMat, class M>
+  std::enable_if_t<is_sized_range_v<OutMat>> matrix_copy(const csr_matrix<T>& A, OutMat& B, M&& map) {
+    for (std::size_t i = 0; i < A.dim(); ++i) {
+      for (std::size_t j = 0; j < A.dim(); ++j) B[map(i, j)] = range_value_t<OutMat>(0);
+    }
+    const auto& row_ptr = A.row_ptr();
+    const auto& col = A.column_index();
+    const auto& val = A.values();
+    for (std::size_t i = 0; i < A.dim(); ++i) {
+      for (std::size_t p = row_ptr[i]; p < row_ptr[i + 1]; ++p) B[map(i, col[p])] = val[p];
+    }
+  }
+
+  /// @brief Bloch Hamiltonian H(k)_ij = Σ_R t_ij(R) exp(i k·R) of a tight-binding model in CSR format
+  /// @details The hoppings with the same (i, j) share one nonzero, and the phase of each distinct
+  /// lattice vector R is computed once, so that `at(k)` costs one sincos per R and one
+  /// multiply-add per hopping. The sparsity pattern does not depend on k.
+  template <class T, std::size_t D>
+  struct csr_hamiltonian {
+    static_assert(is_complex_v<T>);
+
+  public:
+    /// hopping t from the orbital j in the cell R to the orbital i in the cell 0
+    struct hopping {
+      std::size_t i, j;
+      std::array<double, D> R;
+      T t;
+    };
+
+  private:
+    csr_matrix<T> H_{};
+    std::vector<std::size_t> term_ptr_{}; // hoppings [term_ptr_[p], term_ptr_[p + 1]) of the nonzero p
+    std::vector<std::size_t> term_R_{};   // lattice vector of each hopping
+    std::vector<T> term_t_{};
+    std::vector<std::array<double, D>> R_{};
+    std::vector<T> phase_{};
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    csr_hamiltonian() = default;
+    /// @param n number of orbitals
+    /// @param hoppings all the hoppings (both t_ij(R) and t_ji(-R) = conj(t_ij(R)))
+    csr_hamiltonian(const size_type n, std::vector<hopping> hoppings) {
+      std::stable_sort(hoppings.begin(), hoppings.end(), [](const auto& a, const auto& b) {
+        return std::tie(a.i, a.j) < std::tie(b.i, b.j);
+      });
+      std::map<std::array<double, D>, size_type> index;
+      std::vector<size_type> row_ptr(n + 1, 0), col;
+      term_ptr_.push_back(0);
+      for (std::size_t e = 0; e < hoppings.size(); ++e) {
+        const auto& h = hoppings[e];
+        assert(h.i < n and h.j < n);
+        if (e == 0 or h.i != hoppings[e - 1].i or h.j != hoppings[e - 1].j) {
+          col.push_back(h.j);
+          ++row_ptr[h.i + 1];
+          term_ptr_.push_back(term_ptr_.back());
+        }
+        const auto [it, inserted] = index.try_emplace(h.R, R_.size());
+        if (inserted) R_.push_back(h.R);
+        term_R_.push_back(it->second);
+        term_t_.push_back(h.t);
+        ++term_ptr_.back();
+      }
+      for (std::size_t i = 0; i < n; ++i) row_ptr[i + 1] += row_ptr[i];
+      phase_.resize(R_.size());
+      std::vector<T> val(col.size());
+      H_ = csr_matrix<T>(n, std::move(row_ptr), std::move(col), std::move(val));
+    }
+
+    size_type dim() const noexcept {
+      return H_.dim();
+    }
+    /// H(k) of the last `at`
+    const csr_matrix<T>& matrix() const noexcept {
+      return H_;
+    }
+    /// maximum number of threads of the matrix-vector product (0: hardware concurrency)
+    void threads(const unsigned n) noexcept {
+      H_.threads(n);
+    }
+
+    /// evaluate H(k)
+    const csr_matrix<T>& at(const std::array<double, D>& k) {
+      using real_type = typename T::value_type;
+      for (std::size_t r = 0; r < R_.size(); ++r) {
+        double kR = 0;
+        for (std::size_t d = 0; d < D; ++d) kR += k[d] * R_[r][d];
+        phase_[r] = T(static_cast<real_type>(std::cos(kR)), static_cast<real_type>(std::sin(kR)));
+      }
+      auto& val = H_.values();
+      for (std::size_t p = 0; p < val.size(); ++p) {
+        T sum = 0;
+        for (std::size_t e = term_ptr_[p]; e < term_ptr_[p + 1]; ++e) sum += term_t_[e] * phase_[term_R_[e]];
+        val[p] = sum;
+      }
+      return H_;
+    }
+  }; // struct csr_hamiltonian
+
+  /// @}
+} // namespace kspc
+
+// BLAS threading
+namespace kspc {
+  /// @cond
+  namespace detail {
+#if defined(__GNUC__) && !defined(_WIN32)
+    // threading controls of the optimized BLAS libraries, resolved to null if not linked
+    extern "C" {
+      // OpenBLAS
+      int openblas_get_num_threads() __attribute__((weak));
+      void openblas_set_num_threads(int num_threads) __attribute__((weak));
+
+      // BLIS (dim_t is 64-bit in the default configuration)
+      std::int64_t bli_thread_get_num_threads() __attribute__((weak));
+      void bli_thread_set_num_threads(std::int64_t n_threads) __attribute__((weak));
+
+      // MKL (the thread-local setting; 0 reverts to the global one)
+      int MKL_Get_Max_Threads() __attribute__((weak));
+      int MKL_Set_Num_Threads_Local(int nth) __attribute__((weak));
+    }
+#else
+    // weak symbols are an ELF feature: elsewhere no BLAS library is detected
+    inline constexpr int (*openblas_get_num_threads)() = nullptr;
+    inline constexpr void (*openblas_set_num_threads)(int) = nullptr;
+    inline constexpr std::int64_t (*bli_thread_get_num_threads)() = nullptr;
+    inline constexpr void (*bli_thread_set_num_threads)(std::int64_t) = nullptr;
+    inline constexpr int (*MKL_Get_Max_Threads)() = nullptr;
+    inline constexpr int (*MKL_Set_Num_Threads_Local)(int) = nullptr;
+#endif
+
+    // OpenBLAS and BLIS have a process-wide setting: the first of the concurrent outermost scopes
+    // saves it and the last one restores it
+    struct blas_threads_state {
+      std::mutex mutex{};
+      std::size_t depth = 0;
+      int saved = 0;
+    };
+
+    inline blas_threads_state& global_blas_threads_state() {
+      static blas_threads_state state;
+      return state;
+    }
+
+    // nesting depth of the scopes in the calling thread
+    inline std::size_t& local_blas_threads_depth() {
+      thread_local std::size_t depth = 0;
+      return depth;
+    }
+  } // namespace detail
+  /// @endcond
+
+  /// @addtogroup linalg
+  /// @{
+
+  /// BLAS library detected at run time
+  enum class blas_vendor {
+    unknown,  ///< no threading control (e.g. the reference BLAS)
+    openblas, ///< OpenBLAS
+    blis,     ///< BLIS
+    mkl,      ///< Intel MKL
+  };
+
+  /// detect the BLAS library linked into the program by its threading functions
+  inline blas_vendor detect_blas_vendor() noexcept {
+    if (detail::MKL_Set_Num_Threads_Local and detail::MKL_Get_Max_Threads) return blas_vendor::mkl;
+    if (detail::openblas_set_num_threads and detail::openblas_get_num_threads) return blas_vendor::openblas;
+    if (detail::bli_thread_set_num_threads and detail::bli_thread_get_num_threads) return blas_vendor::blis;
+    return blas_vendor::unknown;
+  }
+
+  /// number of the BLAS threads (0 if unknown)
+  inline int blas_num_threads() noexcept {
+    switch (detect_blas_vendor()) {
+    case blas_vendor::mkl: return detail::MKL_Get_Max_Threads();
+    case blas_vendor::openblas: return detail::openblas_get_num_threads();
+    case blas_vendor::blis: return static_cast<int>(detail::bli_thread_get_num_threads());
+    default: return 0;
+    }
+  }
+
+  /// @brief set the number of the BLAS threads in a scope
+  /// @details Use `blas_threads_scope(1)` in each task of a parallel loop (e.g. over k-points)
+  /// so that `eigen_solve` and the other LAPACK calls do not oversubscribe the cores, and a larger
+  /// number around a single large call. A nested scope restores the setting of the enclosing one.
+  /// With MKL the setting is local to the calling thread. With OpenBLAS and BLIS it is
+  /// process-wide, and the value before the outermost scopes of concurrent threads is restored
+  /// when the last of them ends, except that a BLIS setting that was never made (-1) is left at
+  /// the value of the scope, since BLIS cannot go back to it. Without a known BLAS, and on
+  /// platforms without weak symbols (e.g. Windows), this does nothing.
+  struct blas_threads_scope {
+  private:
+    blas_vendor vendor_;
+    int saved_ = 0;
+    bool nested_ = false;
+
+  public:
+    /// @param n number of threads (> 0)
+    explicit blas_threads_scope(const int n) : vendor_(detect_blas_vendor()) {
+      assert(n > 0);
+      switch (vendor_) {
+      case blas_vendor::mkl: saved_ = detail::MKL_Set_Num_Threads_Local(n); break;
+      case blas_vendor::openblas:
+      case blas_vendor::blis: {
+        auto& state = detail::global_blas_threads_state();
+        const std::lock_guard lock(state.mutex);
+        nested_ = detail::local_blas_threads_depth()++ > 0;
+        saved_ = blas_num_threads();
+        if (not nested_ and state.depth++ == 0) state.saved = saved_;
+        set(n);
+        break;
+      }
+      default: break;
+      }
+    }
+    blas_threads_scope(const blas_threads_scope&) = delete;
+    blas_threads_scope& operator=(const blas_threads_scope&) = delete;
+    ~blas_threads_scope() {
+      switch (vendor_) {
+      case blas_vendor::mkl: detail::MKL_Set_Num_Threads_Local(saved_); break;
+      case blas_vendor::openblas:
+      case blas_vendor::blis: {
+        auto& state = detail::global_blas_threads_state();
+        const std::lock_guard lock(state.mutex);
+        --detail::local_blas_threads_depth();
+        if (nested_) {
+          set(saved_);
+        } else if (--state.depth == 0) {
+          set(state.saved);
+        }
+        break;
+      }
+      default: break;
+      }
+    }
+
+    /// detected BLAS library
+    blas_vendor vendor() const noexcept {
+      return vendor_;
+    }
+
+  private:
+    void set(const int n) const {
+      if (vendor_ == blas_vendor::openblas) detail::openblas_set_num_threads(n);
+      if (vendor_ == blas_vendor::blis and n > 0) detail::bli_thread_set_num_threads(n);
+    }
+  }; // struct blas_threads_scope
+
+  /// @}
+} // namespace kspc
+
+// Wilson loop
+namespace kspc {
+  /// @cond
+  namespace detail {
+    extern "C" {
+      // eigenvalues of a general matrix (of the unitary Wilson loop)
+      void cgeev_(const char& jobvl, const char& jobvr, const std::size_t& n, std::complex<float>* A, const std::size_t& lda, std::complex<float>* w, std::complex<float>* vl, const std::size_t& ldvl, std::complex<float>* vr, const std::size_t& ldvr, std::complex<float>* work, const std::size_t& lwork, float* rwork, int& info);
+      void zgeev_(const char& jobvl, const char& jobvr, const std::size_t& n, std::complex<double>* A, const std::size_t& lda, std::complex<double>* w, std::complex<double>* vl, const std::size_t& ldvl, std::complex<double>* vr, const std::size_t& ldvr, std::complex<double>* work, const std::size_t& lwork, double* rwork, int& info);
+    }
+
+    inline void geev(const char& jobvl, const char& jobvr, const std::size_t& n, std::complex<float>* A, const std::size_t& lda, std::complex<float>* w, std::complex<float>* vl, const std::size_t& ldvl, std::complex<float>* vr, const std::size_t& ldvr, std::complex<float>* work, const std::size_t& lwork, float* rwork, int& info) {
+      cgeev_(jobvl, jobvr, n, A, lda, w, vl, ldvl, vr, ldvr, work, lwork, rwork, info);
+    }
+    inline void geev(const char& jobvl, const char& jobvr, const std::size_t& n, std::complex<double>* A, const std::size_t& lda, std::complex<double>* w, std::complex<double>* vl, const std::size_t& ldvl, std::complex<double>* vr, const std::size_t& ldvr, std::complex<double>* work, const std::size_t& lwork, double* rwork, int& info) {
+      zgeev_(jobvl, jobvr, n, A, lda, w, vl, ldvl, vr, ldvr, work, lwork, rwork, info);
+    }
+  } // namespace detail
+  /// @endcond
+
+  /// @addtogroup linalg
+  /// @{
+
+  /// @brief Wannier charge centers from the Wilson loops of the lowest bands along k-paths
+  /// @details Each path k_0, ..., k_N (k_N = k_0 + G) is discretized into `steps` segments.
+  /// The Hamiltonian is diagonalized at k_0, ..., k_{N-1}, and the Wilson loop W = M_0 ... M_{N-1}
+  /// is the product of the overlaps M_j = U(k_j)^† U(k_{j+1}) of the `nocc` lowest eigenvectors,
+  /// closed by U(k_N) = U(k_0). H(k) must therefore be periodic, H(k + G) = H(k) (the orbital
+  /// positions are not included in the Bloch phases). The eigenvalues e^{2πiθ} of W give the
+  /// Wannier centers θ ∈ (-1/2, 1/2] in units of the lattice period along the path. The paths are
+  /// distributed over threads, each of which owns its buffers (and runs BLAS single-threaded), so
+  /// that repeated calls do not allocate.
+  template <class T = std::complex<double>>
+  struct wilson_loop {
+  private:
+    static_assert(is_complex_v<T>);
+    using real_type = typename T::value_type;
+
+    // buffers of a thread
+    struct buffers {
+      std::vector<T> U0{}, U1{}, U2{}, M{}, W{}, Wnext{}, lambda{}, work{};
+      std::vector<real_type> w{}, rwork{}, theta{};
+      hermitian::eigen_workspace<T> ws{};
+    };
+
+    std::size_t n_ = 0;
+    std::size_t nocc_ = 0;
+    std::size_t steps_ = 0;
+    unsigned threads_ = 0;
+    std::vector<buffers> buffers_{};
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    wilson_loop() = default;
+    /// @param n dimension of H(k)
+    /// @param nocc number of the (lowest) bands in the loop
+    /// @param steps number of the segments of each path
+    /// @param threads maximum number of threads (0: hardware concurrency)
+    wilson_loop(const size_type n, const size_type nocc, const size_type steps, const unsigned threads = 0)
+      : n_(n), nocc_(nocc), steps_(steps), threads_(threads) {
+      assert(0 < nocc and nocc <= n and steps > 0);
+      const unsigned count = threads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : threads;
+      buffers_.resize(count);
+      for (auto& b : buffers_) {
+        b.U0.resize(n * n);
+        b.U1.resize(n * n);
+        b.U2.resize(n * n);
+        b.M.resize(nocc * nocc);
+        b.W.resize(nocc * nocc);
+        b.Wnext.resize(nocc * nocc);
+        b.lambda.resize(nocc);
+        b.work.resize(2 * nocc);
+        b.w.resize(n);
+        b.rwork.resize(2 * nocc);
+        b.theta.resize(nocc);
+        b.ws.reserve(n, hermitian::algorithm::automatic);
+      }
+    }
+
+    /// @brief Wannier centers of `count` paths
+    /// @param hamiltonian `hamiltonian(k, H)` stores H(k) in the n-by-n row-major range H
+    /// @param path `path(p, j)` is k_j (j = 0, ..., steps - 1) of the p-th path
+    /// @param centers count-by-nocc row-major output; the centers of each path are sorted
+    /// @return 0, or the first nonzero `info` of LAPACK
+    template <class Hamiltonian, class Path, class OutMat>
+    std::enable_if_t<is_sized_range_v<OutMat>, int>
+    solve(Hamiltonian&& hamiltonian, Path&& path, const size_type count, OutMat& centers) {
+      using std::size; // for ADL
+      assert(size(centers) == count * nocc_);
+      // a default-constructed loop has no bands (and no buffers)
+      if (count == 0 or buffers_.empty()) return 0;
+      std::atomic<std::size_t> next_buffer = 0;
+      std::atomic<int> error = 0;
+      parallel_for(
+        count,
+        [&](const std::size_t first, const std::size_t last) {
+          auto& b = buffers_[next_buffer++];
+          const blas_threads_scope blas(1);
+          for (std::size_t p = first; p < last and error == 0; ++p) {
+            const int info = loop(hamiltonian, path, p, b);
+            if (info != 0) {
+              error = info;
+              break;
+            }
+            for (std::size_t i = 0; i < nocc_; ++i) centers[p * nocc_ + i] = b.theta[i];
+          }
+        },
+        static_cast<unsigned>(buffers_.size()));
+      return error;
+    }
+
+  private:
+    template <class Hamiltonian, class Path>
+    int loop(Hamiltonian& hamiltonian, Path& path, const std::size_t p, buffers& b) const {
+      const auto map = mapping::row_major(n_);
+      const auto map_occ = mapping::row_major(nocc_);
+      int info = 0;
+
+      // eigenvectors in the columns of U (row-major), diagonalized in place; U(k_0) is kept in
+      // U0 and the other k-points alternate between U1 and U2
+      hamiltonian(path(p, std::size_t(0)), b.U0);
+      if ((info = hermitian::eigen_solve(b.U0, b.w, b.ws, map)) != 0) return info;
+
+      std::fill(b.W.begin(), b.W.end(), T(0));
+      for (std::size_t i = 0; i < nocc_; ++i) b.W[map_occ(i, i)] = 1;
+      const std::vector<T>* prev = &b.U0;
+      for (std::size_t j = 1; j <= steps_; ++j) {
+        const std::vector<T>* next = &b.U0;
+        if (j < steps_) {
+          auto& U = prev == &b.U1 ? b.U2 : b.U1;
+          hamiltonian(path(p, j), U);
+          if ((info = hermitian::eigen_solve(U, b.w, b.ws, map)) != 0) return info;
+          next = &U;
+        }
+        // M = U(k_j)^† U(k_{j+1}) of the first nocc columns only, W ← W M
+        std::fill(b.M.begin(), b.M.end(), T(0));
+        for (std::size_t i = 0; i < n_; ++i) {
+          for (std::size_t l = 0; l < nocc_; ++l) {
+            const T u = kspc::conj((*prev)[map(i, l)]);
+            for (std::size_t m = 0; m < nocc_; ++m) b.M[map_occ(l, m)] += u * (*next)[map(i, m)];
+          }
+        }
+        std::fill(b.Wnext.begin(), b.Wnext.end(), T(0));
+        matrix_product(b.W, b.M, b.Wnext, map_occ, map_occ, map_occ);
+        std::swap(b.W, b.Wnext);
+        prev = next;
+      }
+
+      // eigenphases of W (a row-major W is the transpose, which has the same eigenvalues)
+      //          geev(jobvl, jobvr,     n ,        A ,   lda,        w      ,      vl, ldvl,      vr, ldvr,        work ,       lwork   ,        rwork , info)
+      detail::geev(  'N',   'N', nocc_, b.W.data(), nocc_, b.lambda.data(), nullptr,    1, nullptr,    1, b.work.data(), b.work.size(), b.rwork.data(), info);
+      if (info != 0) return info;
+      for (std::size_t i = 0; i < nocc_; ++i) b.theta[i] = std::arg(b.lambda[i]) / (2 * std::numbers::pi_v<real_type>);
+      std::sort(b.theta.begin(), b.theta.end());
+      return 0;
+    }
+  }; // struct wilson_loop
+
   /// @}
 } // namespace kspc
 
@@ -0,0 +1,134 @@
+/// @file mmap.hpp
+#pragma once
+#include <cerrno>     // errno
+#include <cstddef>    // size_t
+#include <utility>    // exchange
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, munmap, madvise, msync
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close, ftruncate, sysconf
+#include <kspc/core.hpp>
+
+// memory-mapped matrix
+namespace kspc {
+  /// @addtogroup linalg
+  /// @{
+
+  /// @brief n-by-n matrix stored in a file and mapped into memory
+  /// @details A sized range with `data()`, so that it can be passed to the linalg functions
+  /// (e.g. `matrix_product_tiled` or `hermitian::eigen_solve`) like a `std::vector`. The pages
+  /// are read from the file on access and written back by the OS. `mapped_matrix<const T>` maps
+  /// the file read-only.
+  template <class T>
+  struct mapped_matrix {
+  private:
+    T* data_ = nullptr;
+    std::size_t n_ = 0;
+    int fd_ = -1;
+
+  public:
+    using value_type = std::remove_cv_t<T>;
+    using size_type = std::size_t;
+    using iterator = T*;
+
+    mapped_matrix() = default;
+    mapped_matrix(const mapped_matrix&) = delete;
+    mapped_matrix& operator=(const mapped_matrix&) = delete;
+    mapped_matrix(mapped_matrix&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr)), n_(std::exchange(other.n_, 0)),
+        fd_(std::exchange(other.fd_, -1)) {}
+    mapped_matrix& operator=(mapped_matrix&& other) noexcept {
+      if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        n_ = std::exchange(other.n_, 0);
+        fd_ = std::exchange(other.fd_, -1);
+      }
+      return *this;
+    }
+    ~mapped_matrix() {
+      close();
+    }
+
+    /// @brief map the file `path` holding the n-by-n matrix
+    /// @details A writable matrix creates the file or extends it to n * n elements. Returns 0,
+    /// or `errno` of the failed system call.
+    int open(const char* path, const size_type n) {
+      close();
+      constexpr bool writable = not std::is_const_v<T>;
+      const size_type bytes = n * n * sizeof(T);
+      const int fd = writable ? ::open(path, O_RDWR | O_CREAT, 0644) : ::open(path, O_RDONLY);
+      if (fd < 0) return errno;
+      struct stat st;
+      if (::fstat(fd, &st) != 0) return fail(fd);
+      if (static_cast<size_type>(st.st_size) < bytes) {
+        if (not writable) return fail(fd, EINVAL);
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) return fail(fd);
+      }
+      void* p = nullptr;
+      if (bytes > 0) {
+        p = ::mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return fail(fd);
+      }
+      data_ = static_cast<T*>(p);
+      n_ = n;
+      fd_ = fd;
+      return 0;
+    }
+
+    /// unmap and close the file
+    void close() noexcept {
+      if (data_) ::munmap(const_cast<std::remove_cv_t<T>*>(data_), n_ * n_ * sizeof(T));
+      if (fd_ >= 0) ::close(fd_);
+      data_ = nullptr;
+      n_ = 0;
+      fd_ = -1;
+    }
+
+    /// write the modified pages back to the file; returns 0 or `errno`
+    int sync() const noexcept {
+      if (data_ and ::msync(const_cast<std::remove_cv_t<T>*>(data_), n_ * n_ * sizeof(T), MS_SYNC) != 0) return errno;
+      return 0;
+    }
+
+    /// hint that the elements [first, last) are read soon
+    void prefetch(const size_type first, const size_type last) const noexcept {
+      if (not data_ or first >= last) return;
+      static const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+      const auto begin = reinterpret_cast<std::uintptr_t>(data_ + first) / page * page;
+      const auto end = reinterpret_cast<std::uintptr_t>(data_ + last);
+      ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+    }
+
+    bool is_open() const noexcept {
+      return fd_ >= 0;
+    }
+    /// matrix dimension
+    size_type extent() const noexcept {
+      return n_;
+    }
+    size_type size() const noexcept {
+      return n_ * n_;
+    }
+    T* data() const noexcept {
+      return data_;
+    }
+    iterator begin() const noexcept {
+      return data_;
+    }
+    iterator end() const noexcept {
+      return data_ + size();
+    }
+    T& operator[](const size_type k) const noexcept {
+      return data_[k];
+    }
+
+  private:
+    static int fail(const int fd, const int error = errno) noexcept {
+      ::close(fd);
+      return error;
+    }
+  }; // struct mapped_matrix
+
+  /// @}
+} // namespace kspc
@@ -0,0 +1,153 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <kspc/approx.hpp>
+#include <kspc/iso2d.hpp>
+
+namespace iso2d = kspc::iso2d;
+
+inline constexpr auto equal_to = [](const auto& x, const auto& y) {
+  return kspc::approx::equal_to(x, y, 1e-6);
+};
+
+struct params_t : iso2d::params_t {
+  double c = 0.0;
+  std::size_t calls = 0;
+};
+
+double circle(const std::array<double, 2>& v, void*) {
+  return v[0] * v[0] + v[1] * v[1];
+}
+
+// undefined everywhere (counting the calls)
+double undefined(const std::array<double, 2>&, void* data) {
+  ++((params_t*)data)->calls;
+  return std::numeric_limits<double>::quiet_NaN();
+}
+double plane(const std::array<double, 2>& v, void*) {
+  return v[0] + 0.5 * v[1];
+}
+
+double waves(const std::array<double, 2>& v, void*) {
+  return std::sin(3.0 * v[0]) * std::cos(2.0 * v[1]);
+}
+
+double saddle(const std::array<double, 2>& v, void* data) {
+  return v[0] * v[1] + ((params_t*)data)->c;
+}
+
+TEST_CASE("isoline_cartesian", "[iso2d]") {
+  { // a circle is one closed polyline
+    params_t params;
+    const auto grid = iso2d::symmetric_grid(-1.0, 1.0, -1.0, 1.0, 21);
+    const auto [vertices, lines] = iso2d::isoline_cartesian(grid, &circle, &params, 0.5);
+    REQUIRE(lines.size() == 1);
+    const auto& line = lines.front();
+    CHECK(line.size() == vertices.size() + 1);
+    CHECK(line.front() == line.back());
+    for (const auto& v : vertices) CHECK(std::abs(std::hypot(v[0], v[1]) - std::sqrt(0.5)) < 1e-3);
+  }
+  { // a contour across the boundary of the grid is an open polyline
+    params_t params;
+    const auto grid = iso2d::symmetric_grid(-1.0, 1.0, -1.0, 1.0, 11);
+    const auto [vertices, lines] = iso2d::isoline_cartesian(grid, &plane, &params, 0.1);
+    REQUIRE(lines.size() == 1);
+    const auto& line = lines.front();
+    CHECK(line.size() == vertices.size());
+    CHECK(line.front() != line.back());
+    for (const auto k : {line.front(), line.back()}) {
+      const auto& v = vertices[k];
+      CHECK((equal_to(std::abs(v[0]), 1.0) or equal_to(std::abs(v[1]), 1.0)));
+    }
+    for (const auto& v : vertices) CHECK(equal_to(plane(v, &params), 0.1));
+  }
+  { // a saddle cell is resolved by the sign of the average of its corners
+    params_t params;
+    const iso2d::CartesianGrid grid{2, 2, -1.0, 2.0, -1.0, 2.0};
+    // c > 0: the positive corners (-1, -1) and (1, 1) are connected, so that each segment
+    // joins x - y = ±(1 + c)
+    params.c = 0.25;
+    {
+      const auto [vertices, lines] = iso2d::isoline_cartesian(grid, &saddle, &params, 0.0);
+      CHECK(vertices.size() == 4);
+      REQUIRE(lines.size() == 2);
+      for (const auto& line : lines) {
+        REQUIRE(line.size() == 2);
+        const auto &a = vertices[line[0]], &b = vertices[line[1]];
+        CHECK(equal_to(a[0] - a[1], b[0] - b[1]));
+        CHECK(equal_to(std::abs(a[0] - a[1]), 1.25));
+      }
+    }
+    // c < 0: the negative corners (1, -1) and (-1, 1) are connected, so that each segment
+    // joins x + y = ±(1 - c)
+    params.c = -0.25;
+    {
+      const auto [vertices, lines] = iso2d::isoline_cartesian(grid, &saddle, &params, 0.0);
+      CHECK(vertices.size() == 4);
+      REQUIRE(lines.size() == 2);
+      for (const auto& line : lines) {
+        REQUIRE(line.size() == 2);
+        const auto &a = vertices[line[0]], &b = vertices[line[1]];
+        CHECK(equal_to(a[0] + a[1], b[0] + b[1]));
+        CHECK(equal_to(std::abs(a[0] + a[1]), 1.25));
+      }
+    }
+  }
+  { // the result does not depend on the number of threads
+    params_t params;
+    const auto grid = iso2d::symmetric_grid(-2.0, 2.0, -2.0, 2.0, 61);
+    params.threads = 1;
+    const auto [vertices1, lines1] = iso2d::isoline_cartesian(grid, &waves, &params, 0.2);
+    params.threads = 4;
+    const auto [vertices4, lines4] = iso2d::isoline_cartesian(grid, &waves, &params, 0.2);
+    CHECK(lines1.size() > 1);
+    CHECK(vertices1 == vertices4);
+    CHECK(lines1 == lines4);
+  }
+  { // adaptive sampling of a smooth function matches the full grid with fewer evaluations
+    params_t params;
+    const auto grid = iso2d::symmetric_grid(-1.0, 1.0, -1.0, 1.0, 65);
+    const auto [vertices, lines] = iso2d::isoline_cartesian(grid, &circle, &params, 0.5);
+    const auto [avertices, alines, stats] = iso2d::isoline_cartesian_adaptive(grid, &circle, &params, 0.5);
+    CHECK(alines == lines);
+    REQUIRE(avertices.size() == vertices.size());
+    for (std::size_t k = 0; k < vertices.size(); ++k) {
+      CHECK(std::abs(avertices[k][0] - vertices[k][0]) < 1e-6);
+      CHECK(std::abs(avertices[k][1] - vertices[k][1]) < 1e-6);
+    }
+    CHECK(stats.evaluations < grid.nx * grid.ny);
+    CHECK(stats.evaluations + stats.saved == grid.nx * grid.ny);
+  }
+  { // NaN values of the function are evaluated once like any other
+    params_t params;
+    const auto grid = iso2d::symmetric_grid(-1.0, 1.0, -1.0, 1.0, 65);
+    const auto [vertices, lines, stats] = iso2d::isoline_cartesian_adaptive(grid, &undefined, &params, 0.5);
+    CHECK(lines.empty());
+    // only the corners of the initial 8 × 8 cells
+    CHECK(stats.evaluations == 9 * 9);
+    CHECK(params.calls == stats.evaluations);
+    CHECK(stats.evaluations + stats.saved == grid.nx * grid.ny);
+  }
+  { // the levels from one sampling equal separate extractions
+    params_t params;
+    params.threads = 2;
+    const auto grid = iso2d::symmetric_grid(-1.0, 1.0, -1.0, 1.0, 41);
+    CHECK(iso2d::isoline_cartesian_levels(grid, &circle, &params, {}).empty());
+    // -0.5 is below the range of the function
+    const std::vector<double> isos{0.25, -0.5, 0.5};
+    const auto results = iso2d::isoline_cartesian_levels(grid, &circle, &params, isos);
+    REQUIRE(results.size() == isos.size());
+    for (std::size_t l = 0; l < isos.size(); ++l) {
+      const auto [vertices, lines] = iso2d::isoline_cartesian(grid, &circle, &params, isos[l]);
+      CHECK(results[l].first == vertices);
+      CHECK(results[l].second == lines);
+    }
+    CHECK(results[1].first.empty());
+    CHECK(results[1].second.empty());
+  }
+}
@@ -3,11 +3,13 @@
 
 #include <array>
 #include <complex>
+#include <filesystem>
 #include <vector>
 #include <kspc/approx.hpp>
 #include <kspc/core.hpp>
 #include <kspc/linalg.hpp>
 #include <kspc/math.hpp>
+#include <kspc/mmap.hpp>
 #include <kspc/numeric.hpp>
 
 inline constexpr auto equal_to = [](const auto& x, const auto& y) {
@@ -149,4 +151,798 @@ TEST_CASE("linalg", "[math][linalg]") {
     CHECK(equal_to(w[0], 1.0));
     CHECK(equal_to(w[1], 4.0));
   }
+  { // hermitian::eigen_solve with a reusable workspace
+    using namespace std::complex_literals;
+    // clang-format off
+    const std::vector<std::complex<double>> A0{
+      2.0, 1.0 + 1.0i,
+      1.0 - 1.0i, 3.0,
+    };
+    // clang-format on
+    const auto n = kspc::dim(A0);
+    std::vector<double> w(n);
+    const auto row_major = kspc::mapping::row_major(n);
+    kspc::hermitian::eigen_workspace<std::complex<double>> ws(n);
+    const auto* work = ws.work().data();
+    for (int i = 0; i < 2; ++i) {
+      auto A = A0;
+      const auto info = kspc::hermitian::eigen_solve(A, w, ws, row_major);
+      CHECK(info == 0);
+      CHECK(equal_to(w[0], 1.0));
+      CHECK(equal_to(w[1], 4.0));
+    }
+    CHECK(ws.work().data() == work);
+    auto A = A0;
+    const auto info = kspc::hermitian::no_evec::eigen_solve(A, w, ws, row_major);
+    CHECK(info == 0);
+    CHECK(equal_to(w[0], 1.0));
+    CHECK(equal_to(w[1], 4.0));
+  }
+  { // hermitian::eigen_solve with row-major and column-major dynamic matrices without copy
+    using namespace std::complex_literals;
+    // clang-format off
+    const std::vector<std::complex<double>> A0{
+      2.0, 1.0 + 1.0i,
+      1.0 - 1.0i, 3.0,
+    };
+    // clang-format on
+    const auto n = kspc::dim(A0);
+    const auto row_major = kspc::mapping::row_major(n);
+    const auto column_major = kspc::mapping::column_major(n);
+    auto check = [&](const auto& map0, const auto& map) {
+      auto A = A0;
+      std::vector<double> w(n);
+      const auto info = kspc::hermitian::eigen_solve(A, w, map);
+      CHECK(info == 0);
+      CHECK(equal_to(w[0], 1.0));
+      CHECK(equal_to(w[1], 4.0));
+      // A0 v_k = w_k v_k, where v_k is the k-th column of A
+      for (std::size_t k = 0; k < n; ++k)
+        for (std::size_t i = 0; i < n; ++i) {
+          std::complex<double> Av = 0.0;
+          for (std::size_t j = 0; j < n; ++j) Av += A0[map0(i, j)] * A[map(j, k)];
+          CHECK(equal_to(Av, w[k] * A[map(i, k)]));
+        }
+    };
+    check(row_major, row_major);
+    check(column_major, column_major);
+  }
+  { // hermitian::eigen_solve for selected eigenvalues
+    // clang-format off
+    // tridiagonal matrix with eigenvalues 2 - 2 cos(k π / 5) (k = 1, ..., 4)
+    const std::vector<double> A0{
+       2.0, -1.0,  0.0,  0.0,
+      -1.0,  2.0, -1.0,  0.0,
+       0.0, -1.0,  2.0, -1.0,
+       0.0,  0.0, -1.0,  2.0,
+    };
+    // clang-format on
+    const auto n = kspc::dim(A0);
+    std::array<double, 4> expected;
+    for (std::size_t k = 0; k < n; ++k)
+      expected[k] = 2.0 - 2.0 * std::cos(static_cast<double>(k + 1) * kspc::pi / 5.0);
+    const auto row_major = kspc::mapping::row_major(n);
+    kspc::hermitian::eigen_workspace<double> ws;
+    std::vector<double> w(n);
+    std::size_t m = 0;
+
+    auto A = A0;
+    auto info = kspc::hermitian::eigen_solve(A, kspc::hermitian::index_range{1, 2}, m, w, ws, row_major);
+    CHECK(info == 0);
+    CHECK(m == 2);
+    CHECK(equal_to(w[0], expected[1]));
+    CHECK(equal_to(w[1], expected[2]));
+    for (std::size_t k = 0; k < m; ++k)
+      for (std::size_t i = 0; i < n; ++i) {
+        double Av = 0.0;
+        for (std::size_t j = 0; j < n; ++j) Av += A0[row_major(i, j)] * A[row_major(j, k)];
+        CHECK(equal_to(Av, w[k] * A[row_major(i, k)]));
+      }
+
+    A = A0;
+    info = kspc::hermitian::no_evec::eigen_solve(A, kspc::hermitian::value_range{0.0, 2.0}, m, w, ws, row_major);
+    CHECK(info == 0);
+    CHECK(m == 2);
+    CHECK(equal_to(w[0], expected[0]));
+    CHECK(equal_to(w[1], expected[1]));
+  }
+  { // hermitian::eigen_solve with each algorithm
+    using namespace std::complex_literals;
+    // clang-format off
+    const std::vector<std::complex<double>> A0{
+      2.0, 1.0 + 1.0i,
+      1.0 - 1.0i, 3.0,
+    };
+    // clang-format on
+    const auto n = kspc::dim(A0);
+    const auto row_major = kspc::mapping::row_major(n);
+    const auto column_major = kspc::mapping::column_major(n);
+    kspc::hermitian::eigen_workspace<std::complex<double>> ws;
+    for (const auto algo :
+         {kspc::hermitian::algorithm::automatic, kspc::hermitian::algorithm::qr,
+          kspc::hermitian::algorithm::divide_and_conquer, kspc::hermitian::algorithm::mrrr}) {
+      auto A = A0;
+      std::vector<double> w(n);
+      const auto info = kspc::hermitian::eigen_solve(A, w, ws, algo, column_major);
+      CHECK(info == 0);
+      CHECK(equal_to(w[0], 1.0));
+      CHECK(equal_to(w[1], 4.0));
+      for (std::size_t k = 0; k < n; ++k)
+        for (std::size_t i = 0; i < n; ++i) {
+          std::complex<double> Av = 0.0;
+          for (std::size_t j = 0; j < n; ++j) Av += A0[column_major(i, j)] * A[column_major(j, k)];
+          CHECK(equal_to(Av, w[k] * A[column_major(i, k)]));
+        }
+
+      A = A0;
+      CHECK(kspc::hermitian::eigen_solve(A, w, algo, row_major) == 0);
+      CHECK(equal_to(w[0], 1.0));
+      CHECK(equal_to(w[1], 4.0));
+    }
+  }
+  { // hermitian::unitary_transform
+    using namespace std::complex_literals;
+    // clang-format off
+    const std::vector<std::complex<double>> A0{
+      1.0, 2.0 - 1.0i, 0.5i,
+      2.0 + 1.0i, -1.0, 3.0,
+      -0.5i, 3.0, 2.0,
+    };
+    // clang-format on
+    const auto n = kspc::dim(A0);
+    const auto row_major = kspc::mapping::row_major(n);
+    // U: eigenvectors of a hermitian matrix
+    auto U = A0;
+    std::vector<double> w(n);
+    kspc::hermitian::eigen_solve(U, w, row_major);
+
+    auto A = A0;
+    kspc::unitary_transform(A, U, row_major, row_major);
+    auto A_upper = A0; // only the upper triangle is read
+    for (std::size_t i = 0; i < n; ++i)
+      for (std::size_t j = 0; j < i; ++j) A_upper[row_major(i, j)] = 0.0;
+    std::vector<std::complex<double>> C(n * n);
+    kspc::hermitian::unitary_transform(A_upper, U, C, row_major, row_major);
+    CHECK(equal(A_upper, A));
+    for (std::size_t i = 0; i < n; ++i) CHECK(equal_to(A[row_major(i, i)], w[i]));
+  }
+  { // unitary_transform of several matrices
+    using namespace std::complex_literals;
+    constexpr std::size_t N = 2;
+    // clang-format off
+    const std::array<std::complex<double>, N * N> A0{
+      2.0i, 4.0 + 4.0i,
+      -4.0 + 4.0i, -2.0i,
+    };
+    const std::array<std::complex<double>, N * N> H0{
+      1.0, 2.0 - 1.0i,
+      2.0 + 1.0i, -1.0,
+    };
+    constexpr double sqrt3 = kspc::sqrt3;
+    const std::array<std::complex<double>, N * N> U{
+      -1.0 / sqrt3, (1.0 - 1.0i) / sqrt3,
+      (1.0 + 1.0i) / sqrt3, 1.0 / sqrt3,
+    };
+    // clang-format on
+    constexpr auto row_major = kspc::mapping::row_major(N);
+    auto A1 = A0, H1 = H0;
+    kspc::unitary_transform(A1, U, row_major, row_major);
+    kspc::unitary_transform(H1, U, row_major, row_major);
+
+    auto A2 = A0, H2 = H0;
+    kspc::unitary_transform(std::tie(A2, H2), U, row_major, row_major);
+    CHECK(equal(A2, A1));
+    CHECK(equal(H2, H1));
+
+    auto H3 = H0, H4 = H0;
+    std::vector<std::complex<double>> C(2 * N * N);
+    kspc::hermitian::unitary_transform(std::tie(H3, H4), U, C, row_major, row_major);
+    CHECK(equal(H3, H1));
+    CHECK(equal(H4, H1));
+  }
+  { // single precision
+    using namespace std::complex_literals;
+    // clang-format off
+    std::vector A{
+      2.0f,  1.0f, -3.0f,
+      2.0f, -1.0f, -1.0f,
+      1.0f, -1.0f, -2.0f,
+    };
+    // clang-format on
+    std::vector b{-2.0f, -2.0f, -5.0f};
+    const auto row_major = kspc::mapping::row_major(kspc::dim(A));
+    CHECK(kspc::matrix_vector_solve(A, b, row_major) == 0);
+    CHECK(equal(b, std::vector{1.0f, 2.0f, 2.0f}));
+
+    // clang-format off
+    std::array<std::complex<float>, 4> H{
+      2.0f, 1.0f + 1.0if,
+      1.0f - 1.0if, 3.0f,
+    };
+    // clang-format on
+    std::array<float, 2> w;
+    constexpr auto row_major2 = kspc::mapping::row_major(2);
+    CHECK(kspc::hermitian::eigen_solve(H, w, row_major2) == 0);
+    CHECK(equal_to(w[0], 1.0f));
+    CHECK(equal_to(w[1], 4.0f));
+  }
+  { // mixed_precision::matrix_vector_solve
+    using namespace std::complex_literals;
+    // clang-format off
+    const std::vector A{
+      2.0,  1.0, -3.0,
+      2.0, -1.0, -1.0,
+      1.0, -1.0, -2.0,
+    };
+    // clang-format on
+    const auto row_major = kspc::mapping::row_major(kspc::dim(A));
+    std::vector b{-2.0, -2.0, -5.0};
+    CHECK(kspc::mixed_precision::matrix_vector_solve(A, b, row_major) == 0);
+    CHECK(equal(b, std::vector{1.0, 2.0, 2.0}));
+
+    const std::vector<std::complex<double>> Z{
+      2.0i, 1.0, -3.0, 2.0, -1.0i, -1.0, 1.0, -1.0, -2.0,
+    };
+    const std::vector<std::complex<double>> x{1.0, 2.0i, 2.0};
+    std::vector<std::complex<double>> c(3, 0.0);
+    for (std::size_t i = 0; i < 3; ++i)
+      for (std::size_t j = 0; j < 3; ++j) c[i] += Z[row_major(i, j)] * x[j];
+    CHECK(kspc::mixed_precision::matrix_vector_solve(Z, c, row_major) == 0);
+    CHECK(equal(c, x));
+  }
+  { // lu_factorization
+    // clang-format off
+    const std::vector A{
+      2.0,  1.0, -3.0,
+      2.0, -1.0, -1.0,
+      1.0, -1.0, -2.0,
+    };
+    // clang-format on
+    const auto row_major = kspc::mapping::row_major(kspc::dim(A));
+    const kspc::lu_factorization<double> lu(A, row_major);
+    CHECK(lu.info() == 0);
+    std::vector b{-2.0, -2.0, -5.0};
+    CHECK(lu.solve(b) == 0);
+    CHECK(equal(b, std::vector{1.0, 2.0, 2.0}));
+    // two right-hand sides in column-major order
+    std::vector B{-2.0, -2.0, -5.0, 3.0, 1.0, 0.0};
+    CHECK(lu.solve(B) == 0);
+    CHECK(equal(B, std::vector{1.0, 2.0, 2.0, 1.0, 1.0, 0.0}));
+  }
+  { // matrix_view
+    using namespace std::complex_literals;
+    // clang-format off
+    std::array<std::complex<double>, 4> A{
+      2.0, 1.0 + 1.0i,
+      1.0 - 1.0i, 3.0,
+    };
+    // clang-format on
+    kspc::matrix_view a(A);
+    static_assert(decltype(a)::static_extent == 2);
+    static_assert(kspc::is_fixed_size_array_v<decltype(a)>);
+    static_assert(kspc::fixed_size_matrix_dim_v<decltype(a)> == 2);
+    CHECK(kspc::dim(a) == 2);
+    CHECK(a(0, 1) == A[1]);
+
+    std::vector<std::complex<double>> B(A.begin(), A.end());
+    kspc::matrix_view b(B);
+    static_assert(decltype(b)::static_extent == kspc::dynamic_extent);
+    static_assert(not kspc::is_fixed_size_array_v<decltype(b)>);
+    CHECK(kspc::dim(b) == 2);
+
+    std::array<double, 2> w;
+    CHECK(kspc::hermitian::no_evec::eigen_solve(b, w) == 0);
+    CHECK(equal_to(w[0], 1.0));
+    CHECK(equal_to(w[1], 4.0));
+    CHECK(kspc::hermitian::eigen_solve(a, w) == 0);
+    CHECK(equal_to(w[0], 1.0));
+    CHECK(equal_to(w[1], 4.0));
+
+    // A now holds the eigenvectors in row-major order
+    kspc::unitary_transform(b, a);
+    CHECK(equal_to(b(0, 0), 1.0));
+    CHECK(equal_to(b(1, 1), 4.0));
+    CHECK(equal_to(b(0, 1), 0.0));
+
+    std::vector<std::complex<double>> C(4);
+    kspc::matrix_product(a, kspc::matrix_view<std::complex<double>, 2>(B.data()), kspc::matrix_view(C));
+    CHECK(equal_to(C[0], A[0]));
+    CHECK(equal_to(C[1], 4.0 * A[1]));
+  }
+  { // unrolled kernels for fixed-size matrices
+    constexpr auto product = [] {
+      constexpr auto row_major = kspc::mapping::row_major(2);
+      std::array A{1.0, 2.0, 3.0, 4.0};
+      std::array B{0.0, 1.0, 1.0, 0.0};
+      std::array<double, 4> C{};
+      kspc::matrix_product(A, B, C, row_major, row_major, row_major);
+      std::array<double, 4> D{};
+      kspc::matrix_copy(C, D, row_major, kspc::mapping::column_major(2));
+      kspc::unitary_transform(A, B, C, row_major, row_major);
+      return std::pair(D, A);
+    }();
+    static_assert(product.first == std::array{2.0, 4.0, 1.0, 3.0});
+    static_assert(product.second == std::array{4.0, 3.0, 2.0, 1.0});
+
+    using namespace std::complex_literals;
+    // clang-format off
+    const std::array<std::complex<double>, 9> A{
+      1.0, 2.0 - 1.0i, 0.5i,
+      2.0 + 1.0i, -1.0, 3.0,
+      -0.5i, 3.0, 2.0,
+    };
+    // clang-format on
+    const std::vector<std::complex<double>> B(A.begin(), A.end());
+    constexpr auto row_major = kspc::mapping::row_major(3);
+    constexpr auto column_major = kspc::mapping::column_major(3);
+    std::array<std::complex<double>, 9> C{};
+    std::vector<std::complex<double>> D(9);
+    kspc::matrix_product(A, A, C, row_major, column_major, row_major, kspc::conj);
+    kspc::matrix_product(B, B, D, row_major, column_major, row_major, kspc::conj);
+    CHECK(equal(C, D));
+  }
+  { // blocks of a larger matrix processed in place
+    using namespace std::complex_literals;
+    // clang-format off
+    const std::vector<std::complex<double>> A0{
+      2.0, 1.0 + 1.0i, 9.0, 9.0,
+      1.0 - 1.0i, 3.0, 9.0, 9.0,
+      9.0, 9.0, 2.0, 1.0 + 1.0i,
+      9.0, 9.0, 1.0 - 1.0i, 3.0,
+    };
+    // clang-format on
+    const auto row_major = kspc::mapping::row_major(4);
+    const auto column_major = kspc::mapping::column_major(4);
+    {
+      auto A = A0;
+      std::vector<double> w(2);
+      const auto a = kspc::submatrix_view(A, row_major, 2, 2, 2);
+      CHECK(kspc::hermitian::eigen_solve(a, w) == 0);
+      CHECK(equal_to(w[0], 1.0));
+      CHECK(equal_to(w[1], 4.0));
+      // the top-left block transformed by the eigenvectors in the bottom-right block
+      const auto c = kspc::submatrix_view(A, row_major, 0, 0, 2);
+      kspc::unitary_transform(c, a);
+      CHECK(equal_to(c(0, 0), 1.0));
+      CHECK(equal_to(c(0, 1), 0.0));
+      CHECK(equal_to(c(1, 1), 4.0));
+      CHECK(A[row_major(0, 2)] == 9.0);
+      CHECK(A[row_major(3, 1)] == 9.0);
+    }
+    {
+      auto A = A0;
+      std::array<double, 2> w;
+      const auto a = kspc::submatrix_view<2>(A, column_major, 2, 2);
+      CHECK(kspc::hermitian::eigen_solve(a, w) == 0);
+      CHECK(equal_to(w[0], 1.0));
+      CHECK(equal_to(w[1], 4.0));
+      const auto c = kspc::submatrix_view<2>(A, column_major, 0, 0);
+      kspc::hermitian::unitary_transform(c, a);
+      CHECK(equal_to(c(0, 0), 1.0));
+      CHECK(equal_to(c(1, 0), 0.0));
+      CHECK(equal_to(c(1, 1), 4.0));
+      CHECK(A[row_major(0, 2)] == 9.0);
+      CHECK(A[row_major(3, 1)] == 9.0);
+    }
+    {
+      // filling a block leaves the rest of the parent untouched
+      std::vector<double> A(16, 9.0);
+      const auto a = kspc::submatrix_view(A, row_major, 1, 1, 2);
+      CHECK(not a.is_contiguous());
+      CHECK(kspc::submatrix_view(A, row_major, 0, 0, 4).is_contiguous());
+      const kspc::csr_matrix<double> S(2, {{0, 0, 1.0}, {1, 0, 2.0}});
+      kspc::matrix_copy(S, a, a.mapping());
+      for (std::size_t i = 0; i < 4; ++i) {
+        for (std::size_t j = 0; j < 4; ++j) {
+          if (i < 1 or i > 2 or j < 1 or j > 2) CHECK(A[row_major(i, j)] == 9.0);
+        }
+      }
+      CHECK(a(0, 0) == 1.0);
+      CHECK(a(0, 1) == 0.0);
+      CHECK(a(1, 0) == 2.0);
+      CHECK(a(1, 1) == 0.0);
+    }
+  }
+  { // packed storage
+    using namespace std::complex_literals;
+    // clang-format off
+    const std::vector<std::complex<double>> A{
+      1.0, 2.0 - 1.0i, 0.5i,
+      2.0 + 1.0i, -1.0, 3.0,
+      -0.5i, 3.0, 2.0,
+    };
+    // clang-format on
+    const auto n = kspc::dim(A);
+    const auto row_major = kspc::mapping::row_major(n);
+    const auto packed = kspc::mapping::packed_upper();
+    static_assert(kspc::mapping::packed_upper::packed_size(3) == 6);
+    static_assert(kspc::mapping::packed_upper::dim(6) == 3);
+
+    std::vector<std::complex<double>> AP(kspc::mapping::packed_upper::packed_size(n));
+    kspc::hermitian::pack(A, AP, row_major);
+    CHECK(AP[packed(0, 2)] == A[row_major(0, 2)]);
+    std::vector<std::complex<double>> B(n * n);
+    kspc::hermitian::unpack(AP, B, row_major);
+    CHECK(B == A);
+
+    auto V = A;
+    std::vector<double> w0(n);
+    CHECK(kspc::hermitian::eigen_solve(V, w0, row_major) == 0);
+
+    auto AP1 = AP;
+    std::vector<double> w(n);
+    CHECK(kspc::hermitian::no_evec::eigen_solve(AP1, w, packed) == 0);
+    CHECK(equal(w, w0));
+
+    AP1 = AP;
+    std::vector<std::complex<double>> Z(n * n);
+    kspc::hermitian::eigen_workspace<std::complex<double>> ws;
+    CHECK(kspc::hermitian::eigen_solve(AP1, w, Z, ws, packed) == 0);
+    CHECK(equal(w, w0));
+    const auto column_major = kspc::mapping::column_major(n);
+    for (std::size_t k = 0; k < n; ++k)
+      for (std::size_t i = 0; i < n; ++i) {
+        std::complex<double> Av = 0.0;
+        for (std::size_t j = 0; j < n; ++j) Av += A[row_major(i, j)] * Z[column_major(j, k)];
+        CHECK(equal_to(Av, w[k] * Z[column_major(i, k)]));
+      }
+
+    // real symmetric
+    std::vector S{2.0, 1.0, 2.0};
+    std::vector<double> s(2);
+    CHECK(kspc::hermitian::no_evec::eigen_solve(S, s, packed) == 0);
+    CHECK(equal(s, std::vector{1.0, 3.0}));
+  }
+  { // split_complex
+    using namespace std::complex_literals;
+    // clang-format off
+    const std::vector<std::complex<double>> A{
+      1.0, 2.0 - 1.0i, 0.5i,
+      2.0 + 1.0i, -1.0, 3.0,
+      -0.5i, 3.0, 2.0,
+    };
+    const std::vector<std::complex<double>> U{
+      1.0i, 2.0, -1.0 + 0.5i,
+      0.5, 3.0 - 1.0i, 1.0,
+      2.0i, -1.0, 0.25,
+    };
+    // clang-format on
+    const auto row_major = kspc::mapping::row_major(3);
+    const auto column_major = kspc::mapping::column_major(3);
+    kspc::split_complex<double> a, u;
+    kspc::split(A, a);
+    kspc::split(U, u);
+    CHECK(a[1] == A[1]);
+    CHECK(equal_to(kspc::innerp(a, u), kspc::innerp(A, U)));
+    CHECK(equal_to(kspc::innerp(a, u, kspc::identity, kspc::conj), kspc::innerp(A, U, kspc::identity, kspc::conj)));
+
+    std::vector<std::complex<double>> C(9), D(9);
+    kspc::split_complex<double> c(9);
+    kspc::matrix_product(A, U, C, row_major, column_major, row_major, kspc::conj);
+    kspc::matrix_product(a, u, c, row_major, column_major, row_major, kspc::conj);
+    kspc::merge(c, D);
+    CHECK(equal(D, C));
+
+    auto B = A;
+    kspc::unitary_transform(B, U, row_major, row_major);
+    kspc::unitary_transform(a, u, row_major, row_major);
+    kspc::merge(a, D);
+    CHECK(equal(D, B));
+  }
+  { // matrix_element(s)
+    using namespace std::complex_literals;
+    // clang-format off
+    const std::array<std::complex<double>, 9> A{
+      1.0, 2.0 - 1.0i, 0.5i,
+      2.0 + 1.0i, -1.0, 3.0,
+      -0.5i, 3.0, 2.0,
+    };
+    const std::array<std::complex<double>, 9> D{
+      0.0, 1.0i, 2.0,
+      -1.0i, 1.0, 0.5 - 0.5i,
+      2.0, 0.5 + 0.5i, -3.0,
+    };
+    // clang-format on
+    constexpr auto row_major = kspc::mapping::row_major(3);
+    auto V = A;
+    std::array<double, 3> w;
+    kspc::hermitian::eigen_solve(V, w, row_major);
+    auto VDV = D;
+    kspc::unitary_transform(VDV, V, row_major, row_major);
+    auto VAV = A;
+    kspc::unitary_transform(VAV, V, row_major, row_major);
+
+    CHECK(equal_to(kspc::matrix_element(D, V, 0, 2, row_major, row_major), VDV[row_major(0, 2)]));
+    std::array<std::complex<double>, 3> x, y;
+    kspc::matrix_elements(D, V, 1, x, row_major, row_major);
+    for (std::size_t m = 0; m < 3; ++m) CHECK(equal_to(x[m], VDV[row_major(1, m)]));
+    kspc::matrix_elements(std::tie(A, D), V, 2, std::tie(x, y), row_major, row_major);
+    for (std::size_t m = 0; m < 3; ++m) {
+      CHECK(equal_to(x[m], VAV[row_major(2, m)]));
+      CHECK(equal_to(y[m], VDV[row_major(2, m)]));
+    }
+  }
+  { // davidson
+    constexpr std::size_t n = 40, k = 4;
+    // hermitian matrix with a spread diagonal and a complex hopping (column-major)
+    auto hamiltonian = [](double phase) {
+      std::vector<std::complex<double>> H(n * n);
+      for (std::size_t i = 0; i < n; ++i) {
+        H[i + i * n] = 0.25 * static_cast<double>(i % 7) + 0.1 * static_cast<double>(i);
+        const auto j = (i + 1) % n;
+        H[i + j * n] = std::polar(1.0, phase);
+        H[j + i * n] = std::conj(H[i + j * n]);
+      }
+      return H;
+    };
+    auto matvec = [](const auto& H) {
+      return [&H](const std::complex<double>* x, std::complex<double>* y) {
+        for (std::size_t i = 0; i < n; ++i) {
+          y[i] = 0;
+          for (std::size_t j = 0; j < n; ++j) y[i] += H[i + j * n] * x[j];
+        }
+      };
+    };
+    auto reference = [](auto H) {
+      std::vector<double> w(n);
+      kspc::hermitian::eigen_solve(H, w, kspc::mapping::column_major(n));
+      return w;
+    };
+
+    kspc::hermitian::davidson<std::complex<double>> solver(1e-8);
+    const auto H = hamiltonian(0.3);
+    const auto w0 = reference(H);
+    std::vector<double> w(k);
+    std::vector<std::complex<double>> X(n * k);
+    CHECK(solver.solve(matvec(H), w, X) == 0);
+    for (std::size_t i = 0; i < k; ++i) CHECK(equal_to(w[i], w0[i]));
+    // eigenvectors: |A x - λ x| is small
+    std::vector<std::complex<double>> y(n);
+    for (std::size_t i = 0; i < k; ++i) {
+      matvec(H)(X.data() + i * n, y.data());
+      double r = 0;
+      for (std::size_t l = 0; l < n; ++l) r += std::norm(y[l] - w[i] * X[l + i * n]);
+      CHECK(std::sqrt(r) < 1e-6);
+    }
+
+    // preconditioned by the diagonal and restricted to an index range
+    std::vector<double> diag(n);
+    for (std::size_t i = 0; i < n; ++i) diag[i] = std::real(H[i + i * n]);
+    CHECK(solver.solve(matvec(H), diag, kspc::hermitian::index_range{2, 3}, w, X) == 0);
+    for (std::size_t i = 2; i < k; ++i) CHECK(equal_to(w[i], w0[i]));
+
+    // warm start at a neighbouring k-point
+    const auto H1 = hamiltonian(0.31);
+    const auto w1 = reference(H1);
+    auto X1 = X;
+    CHECK(solver.solve(matvec(H1), w, X) == 0);
+    const auto cold = solver.iterations();
+    CHECK(solver.solve(matvec(H1), w, X1, true) == 0);
+    for (std::size_t i = 0; i < k; ++i) CHECK(equal_to(w[i], w1[i]));
+    CHECK(solver.iterations() < cold);
+  }
+  { // csr_matrix and csr_hamiltonian
+    using complex_t = std::complex<double>;
+    // ring of n orbitals in a supercell of 1D chain: H(k) = -Σ (|i><i+1| + h.c.) with the
+    // boundary hopping across the cell, and an on-site potential
+    constexpr std::size_t n = 12;
+    using hamiltonian_t = kspc::csr_hamiltonian<complex_t, 1>;
+    std::vector<hamiltonian_t::hopping> hoppings;
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto j = (i + 1) % n;
+      const std::array<double, 1> R{j == 0 ? 1.0 : 0.0};
+      hoppings.push_back({i, j, R, -1.0});
+      hoppings.push_back({j, i, {-R[0]}, -1.0});
+      hoppings.push_back({i, i, {0.0}, 0.1 * static_cast<double>(i % 3)});
+    }
+    hamiltonian_t H(n, hoppings);
+    const std::array<double, 1> k{0.7};
+    const auto& Hk = H.at(k);
+    CHECK(Hk.nnz() == 3 * n);
+
+    // dense H(k) from the hoppings
+    const auto column_major = kspc::mapping::column_major(n);
+    std::vector<complex_t> A(n * n), B(n * n);
+    for (const auto& h : hoppings) A[column_major(h.i, h.j)] += h.t * std::polar(1.0, k[0] * h.R[0]);
+    kspc::matrix_copy(Hk, B, column_major);
+    CHECK(equal(A, B));
+
+    // as the operator of the iterative eigensolver
+    std::vector<double> w0(n);
+    kspc::hermitian::eigen_solve(B, w0, column_major);
+    kspc::hermitian::davidson<complex_t> solver(1e-8);
+    std::vector<double> w(3);
+    std::vector<complex_t> X(n * 3);
+    CHECK(solver.solve(Hk, Hk.diagonal(), w, X) == 0);
+    for (std::size_t i = 0; i < 3; ++i) CHECK(equal_to(w[i], w0[i]));
+
+    // threaded matrix-vector product of a large matrix from triplets
+    constexpr std::size_t m = 40000;
+    std::vector<std::tuple<std::size_t, std::size_t, complex_t>> entries;
+    for (std::size_t i = 0; i < m; ++i) {
+      for (std::size_t d : {0ul, 1ul, 7ul, 100ul}) entries.emplace_back(i, (i + d) % m, complex_t(1.0, static_cast<double>(d)));
+    }
+    entries.emplace_back(0, 0, 1.0); // summed
+    kspc::csr_matrix<complex_t> S(m, entries);
+    CHECK(S.nnz() == 4 * m);
+    std::vector<complex_t> x(m), y1(m), y2(m);
+    for (std::size_t i = 0; i < m; ++i) x[i] = complex_t(std::cos(static_cast<double>(i)), 1.0);
+    S.threads(1);
+    S(x, y1);
+    S.threads(4);
+    S(x, y2);
+    CHECK(y1 == y2);
+    CHECK(equal_to(y1[0], 2.0 * x[0] + complex_t(1.0, 1.0) * x[1] + complex_t(1.0, 7.0) * x[7] + complex_t(1.0, 100.0) * x[100]));
+  }
+  { // blocked matrix_copy between row-major and column-major layouts
+    constexpr std::size_t n = 301;
+    const auto row_major = kspc::mapping::row_major(n);
+    const auto column_major = kspc::mapping::column_major(n);
+    std::vector<std::complex<double>> A(n * n), B(n * n), C(n * n);
+    for (std::size_t i = 0; i < n * n; ++i) A[i] = {static_cast<double>(i), -static_cast<double>(i % 13)};
+    kspc::matrix_copy(A, B, row_major, column_major, kspc::conj);
+    bool ok = true;
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t j = 0; j < n; ++j) ok = ok and B[column_major(i, j)] == std::conj(A[row_major(i, j)]);
+    }
+    CHECK(ok);
+    kspc::matrix_copy(B, C, column_major, row_major, kspc::conj);
+    CHECK(A == C);
+  }
+  { // closed-form determinant, inverse and linear solve of small matrices
+    using namespace std::complex_literals;
+    static_assert(kspc::determinant(std::array{2.0, 1.0, 1.0, 3.0}, kspc::mapping::row_major(2)) == 5.0);
+    static_assert([] {
+      std::array A{2.0, 1.0, -3.0, 2.0, -1.0, -1.0, 1.0, -1.0, -2.0};
+      std::array b{-2.0, -2.0, -5.0};
+      kspc::small_matrix_vector_solve(A, b, kspc::mapping::row_major(3));
+      return b == std::array{1.0, 2.0, 2.0};
+    }());
+
+    // clang-format off
+    const std::array<std::complex<double>, 16> A{
+      4.0, 1.0i, 2.0, 0.5,
+      -1.0i, 3.0, 1.0 + 1.0i, 0.0,
+      2.0, 1.0 - 1.0i, 5.0, 1.0i,
+      0.5, 0.0, -1.0i, 2.0,
+    };
+    // clang-format on
+    constexpr auto row_major = kspc::mapping::row_major(4);
+    constexpr auto column_major = kspc::mapping::column_major(4);
+    std::vector<std::complex<double>> B(A.begin(), A.end());
+    std::vector<std::size_t> ipiv(4);
+    REQUIRE(kspc::lu_factor(B, ipiv) == 0); // column-major LU of A^T
+    std::complex<double> det = 1.0;
+    for (std::size_t i = 0; i < 4; ++i) det *= (ipiv[i] == i + 1 ? 1.0 : -1.0) * B[i + 4 * i];
+    CHECK(equal_to(kspc::determinant(A, row_major), det));
+
+    std::array<std::complex<double>, 16> Ainv, I;
+    CHECK(kspc::inverse(A, Ainv, row_major, column_major) == 0);
+    kspc::matrix_product(A, Ainv, I, row_major, column_major, row_major);
+    for (std::size_t i = 0; i < 4; ++i) {
+      for (std::size_t j = 0; j < 4; ++j) CHECK(equal_to(I[row_major(i, j)], i == j ? 1.0 : 0.0));
+    }
+
+    const std::array<std::complex<double>, 4> b0{1.0, 2.0i, -1.0, 0.5};
+    auto x = b0;
+    CHECK(kspc::small_matrix_vector_solve(A, x, row_major) == 0);
+    std::vector<std::complex<double>> a(A.begin(), A.end()), y(b0.begin(), b0.end());
+    CHECK(kspc::matrix_vector_solve(a, y, row_major) == 0);
+    CHECK(equal(x, y));
+
+    // matrix_vector_solve of a small fixed-size matrix keeps the LAPACK return code
+    std::array singular{1.0, 2.0, 2.0, 4.0};
+    std::array z{1.0, 1.0};
+    CHECK(kspc::matrix_vector_solve(singular, z, kspc::mapping::row_major(2)) == 2);
+
+    // batched: the second system is singular
+    std::vector<std::array<double, 4>> As{{2.0, 1.0, 1.0, 3.0}, {1.0, 2.0, 2.0, 4.0}, {0.0, 1.0, 1.0, 0.0}};
+    std::vector<std::array<double, 2>> bs{{3.0, 4.0}, {1.0, 1.0}, {5.0, 6.0}};
+    CHECK(kspc::matrix_vector_solve_batched(As, bs, kspc::mapping::row_major(2)) == 1);
+    CHECK(equal(bs[0], std::array{1.0, 1.0}));
+    CHECK(bs[1] == std::array{1.0, 1.0});
+    CHECK(equal(bs[2], std::array{6.0, 5.0}));
+  }
+  { // blas_threads_scope
+    const auto vendor = kspc::detect_blas_vendor();
+    const int threads = kspc::blas_num_threads();
+    {
+      kspc::blas_threads_scope scope(1);
+      CHECK(scope.vendor() == vendor);
+      if (vendor != kspc::blas_vendor::unknown) CHECK(kspc::blas_num_threads() == 1);
+      std::array A{2.0, 1.0, 1.0, 3.0};
+      std::array<double, 2> w;
+      CHECK(kspc::hermitian::eigen_solve(A, w, kspc::mapping::column_major(2)) == 0);
+    }
+    CHECK(kspc::blas_num_threads() == threads);
+  }
+  { // mapped_matrix and matrix_product_tiled
+    using complex_t = std::complex<double>;
+    constexpr std::size_t n = 150;
+    const auto dir = std::filesystem::temp_directory_path();
+    const auto pathA = (dir / "kspc_linalg_test_A.bin").string();
+    const auto pathC = (dir / "kspc_linalg_test_C.bin").string();
+    kspc::mapped_matrix<complex_t> A, C;
+    REQUIRE(A.open(pathA.c_str(), n) == 0);
+    REQUIRE(C.open(pathC.c_str(), n) == 0);
+    CHECK(kspc::dim(A) == n);
+    // hermitian A
+    const auto row_major = kspc::mapping::row_major(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t j = 0; j < n; ++j) {
+        A[row_major(i, j)] = {1.0 / static_cast<double>(1 + i + j), static_cast<double>(i) - static_cast<double>(j)};
+      }
+    }
+    std::vector<complex_t> B(n * n), D(n * n, 0.0);
+    for (std::size_t i = 0; i < n * n; ++i) B[i] = {std::sin(static_cast<double>(i)), 0.5};
+    std::fill(C.begin(), C.end(), 0.0);
+    kspc::matrix_product_tiled(A, B, C, row_major, row_major, row_major, 64);
+    kspc::matrix_product(A, B, D, row_major, row_major, row_major);
+    CHECK(equal(C, D));
+    CHECK(C.sync() == 0);
+
+    // read back, and solve in place in the mapped file
+    kspc::mapped_matrix<const complex_t> C2;
+    REQUIRE(C2.open(pathC.c_str(), n) == 0);
+    CHECK(std::equal(C2.begin(), C2.end(), D.begin()));
+    std::vector<complex_t> E(A.begin(), A.end());
+    std::vector<double> w(n), w2(n);
+    CHECK(kspc::hermitian::eigen_solve(E, w, row_major) == 0);
+    CHECK(kspc::hermitian::eigen_solve(A, w2, row_major) == 0);
+    CHECK(equal(w, w2));
+    A.close();
+    C.close();
+    C2.close();
+    std::filesystem::remove(pathA);
+    std::filesystem::remove(pathC);
+  }
+  { // wilson_loop
+    using complex_t = std::complex<double>;
+    constexpr double pi = 3.141592653589793;
+    // Rice-Mele chain H(kx) = [[m, v + w e^{-ikx}], [v + w e^{ikx}, -m]] with the pump parameter
+    // ky: v = 1 + cos(ky) / 2, m = sin(ky) / 2, w = 1 (the paths run along kx at each ky)
+    constexpr std::size_t paths = 24, steps = 32;
+    auto hamiltonian = [](const std::array<double, 2>& k, std::vector<complex_t>& H) {
+      const double v = 1.0 + 0.5 * std::cos(k[1]), m = 0.5 * std::sin(k[1]);
+      const complex_t h = v + std::polar(1.0, k[0]);
+      H = {m, std::conj(h), h, -m};
+    };
+    auto path = [](const std::size_t p, const std::size_t j) {
+      return std::array{2.0 * pi * static_cast<double>(j) / steps, 2.0 * pi * static_cast<double>(p) / paths};
+    };
+    kspc::wilson_loop<complex_t> wilson(2, 1, steps, 3);
+    std::vector<double> centers(paths);
+    REQUIRE(wilson.solve(hamiltonian, path, paths, centers) == 0);
+    // SSH chain at m = 0: trivial (center 0) for v > w at ky = 0, obstructed (center 1/2) for
+    // v < w at ky = π
+    CHECK(std::abs(centers[0]) < 1e-6);
+    CHECK(std::abs(std::abs(centers[paths / 2]) - 0.5) < 1e-6);
+    // the center is pumped by one lattice period over ky (Chern number ±1)
+    double winding = 0;
+    for (std::size_t p = 0; p < paths; ++p) {
+      double d = centers[(p + 1) % paths] - centers[p];
+      d -= std::round(d);
+      winding += d;
+    }
+    CHECK(std::abs(std::abs(winding) - 1.0) < 1e-6);
+
+    // two bands of two decoupled copies: each center is doubled
+    kspc::wilson_loop<complex_t> wilson2(4, 2, steps);
+    auto hamiltonian2 = [&hamiltonian](const std::array<double, 2>& k, std::vector<complex_t>& H) {
+      std::vector<complex_t> h(4);
+      hamiltonian(k, h);
+      H = {h[0], 0.0, h[1], 0.0, 0.0, h[0] + 0.1, 0.0, h[1], h[2], 0.0, h[3], 0.0, 0.0, h[2], 0.0, h[3] + 0.1};
+    };
+    std::vector<double> centers2(2 * paths);
+    REQUIRE(wilson2.solve(hamiltonian2, path, paths, centers2) == 0);
+    for (std::size_t p = 0; p < paths; ++p) {
+      CHECK(std::abs(centers2[2 * p] - centers[p]) < 1e-6);
+      CHECK(std::abs(centers2[2 * p + 1] - centers[p]) < 1e-6);
+    }
+
+    // a default-constructed loop has nothing to solve
+    kspc::wilson_loop<complex_t> empty;
+    std::vector<double> none;
+    CHECK(empty.solve(hamiltonian, path, 0, none) == 0);
+  }
 }
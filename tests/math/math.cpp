@@ -1,11 +1,12 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
 
-#include <algorithm> // equal
+#include <algorithm> // equal, all_of
 #include <array>
 #include <complex>
 #include <memory>  // shared_ptr
 #include <numeric> // iota
+#include <stdexcept>
 #include <vector>
 #include <kspc/approx.hpp>
 #include <kspc/core.hpp>
@@ -78,6 +79,26 @@ TEST_CASE("core", "[core]") {
     kspc::indirectly_readable_traits<const std::vector<int>::iterator>::value_type,
     int>);
   // clang-format on
+
+  // parallel_for covers [0, n) once and rethrows an exception of any chunk
+  for (const unsigned threads : {1u, 4u}) {
+    std::vector<int> count(100, 0);
+    kspc::parallel_for(
+      count.size(), [&count](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) ++count[i];
+      },
+      threads);
+    CHECK(std::all_of(count.begin(), count.end(), [](int c) { return c == 1; }));
+    const auto throw_at = [threads](std::size_t n) {
+      kspc::parallel_for(
+        100, [n](std::size_t first, std::size_t last) {
+          if (first <= n and n < last) throw std::runtime_error("chunk");
+        },
+        threads);
+    };
+    CHECK_THROWS_AS(throw_at(0), std::runtime_error);
+    CHECK_THROWS_AS(throw_at(99), std::runtime_error);
+  }
 }
 
 TEST_CASE("dim", "[math][dim]") {